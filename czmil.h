@@ -267,7 +267,19 @@ extern "C" {
                - delta_bits              =    (DBS) Delta bit size
                - 64 * DBS                =    Difference from the corresponding value in the central shallow channel (channel[0])
 
-      - Compression types 4 through 7 (future use)
+      - Compression type 4 (adaptive Rice coded first differences, only if [RICE PACKETS] is set in the header):
+               - type_1_start_bits       =    Starting value
+               - delta_bits              =    (K0) Initial Rice parameter
+               - 63 Rice codes           =    Zigzag encoded difference from previous value (see below)
+
+      - Compression type 5 (cross channel difference coded, only if [CROSS CHANNEL PACKETS] is set in the header):
+               - 3 bits                  =    Reference shallow channel (always less than this packet's channel)
+               - num_packets_bits        =    Index of the reference packet in the reference channel
+               - type_3_offset_bits      =    Offset value (offset by 2^type_3_offset_bits - 1 : based on compression type 1 starting value bits)
+               - delta_bits              =    (DBS) Delta bit size
+               - 64 * DBS                =    Difference from the corresponding value in the reference packet
+
+      - Compression types 6 and 7 (future use)
 
 
       The number of bits used for delta values (DBS) is computed in czmil_compress_cwf_record in the czmil.c file.  This 
@@ -295,6 +307,32 @@ extern "C" {
       bits) used to store each difference value.  Then 64 fields of channel difference delta bits of differences from 
       the central shallow channel.
 
+      For compression type 4 we start with 10 bits that contain the starting value followed by 4 bits containing the
+      initial Rice parameter (K0).  Then 63 variable length codes for the differences from the previous value in the
+      packet.  Each difference is zigzag encoded (0, -1, 1, -2, 2... becomes 0, 1, 2, 3, 4...) to give a value Z.  With
+      a Rice parameter of K, Z is stored as Z >> K 1 bits, a 0 bit, and the low K bits of Z.  If Z >> K would be
+      CWF_RICE_ESCAPE (12) or more, we store 12 1 bits followed by Z in CWF_RICE_RAW_BITS (11) bits instead.  K is not
+      stored for each value.  It is the smallest K for which N * 2^K >= A, where A is a running sum of the Z values and
+      N is a running count.  A and N start at 2 * 2^K0 and 2, and both are halved when N reaches CWF_RICE_WINDOW (8).
+      So K follows the recent values and a single spike only costs a few extra bits instead of widening every
+      value in the packet.  This type is only used when it gives a smaller packet than the other types and only in files
+      created with czmil_set_cwf_rice_packets (in czmil_optech.h).  Versions 3.19 through 3.36 of the library used it in
+      every file without setting [RICE PACKETS].
+
+      Compression type 5 is a more general version of type 3 for shallow channels 2 through 7.  The seven shallow channels
+      look at neighboring spots from the same laser pulse so a shallow channel other than the central one is often the
+      best predictor.  We start with 3 bits containing the reference channel and num_packets_bits (from the CWF header)
+      containing the index of the reference packet in that channel.  The encoder always uses the packet in the reference
+      channel with the same packet number (channel_ndx, i.e. the same part of the waveform) as this packet.  That packet's
+      index is only the same as this packet's index when both channels have the same packets populated.  If the reference
+      channel is missing a packet that comes before this one (or has one that this channel doesn't) the index will be
+      different.  Storing the index means the decoder doesn't have to search the reference channel's packet numbers.
+      The reference channel must be a shallow channel that comes before this one in the record so it will already have
+      been unpacked.  The rest is the same as type 3 (11 bit offset, 4 bit delta bits, and 64 fields of differences from
+      the reference packet).  Like type 4 this type is only used in files created with czmil_set_cwf_cross_channel_packets
+      (in czmil_optech.h).  Versions 3.20 through 3.36 of the library used it in every file without setting
+      [CROSS CHANNEL PACKETS].
+
       We assume that the first compression method (bit-packed ten bit values) occurs rarely since any of the other
       compression schemes will, almost invariably, give us better results.
 
@@ -357,8 +395,11 @@ extern "C" {
       - type_bits                        =    [CWF:2] Compression type
       - NPKTS9 CZMIL_DEEP_CHANNEL compressed 64 sample waveform packets [CWF:3]
 
-      - T0 compressed 64 sample waveform packet (this is always first difference compressed, AKA compression type 1, so we skip
-        the compression type) [CWF:4]
+      - 1 bit                            =    [CWF:4-0] T0 prediction flag (only if [T0 KEY INTERVAL] is set in the header and
+                                                  this is not a key record, version 3.21 and later)
+      - T0 compressed 64 sample waveform packet (this is first difference compressed, AKA compression type 1, so we skip
+        the compression type.  If the T0 prediction flag is set it is stored like compression type 3 but as differences from
+        the previous record's T0) [CWF:4]
 
       - shot_id_bits                     =    [CWF:5] Shot ID from MCWP
       - time_bits                        =    [CWF:6] Timestamp as an offset from the start timestamp in the header
@@ -366,6 +407,22 @@ extern "C" {
       - 9 times validity_reason_bits     =    [CWF:8] Per channel waveform validity reasons
 
 
+      Consecutive T0 pulses from the same laser are nearly identical.  If the file was created with a T0 key interval
+      (see czmil_set_cwf_t0_key_interval in czmil_optech.h) the T0 of any record whose record number is not a multiple of
+      the interval may be stored as differences from the T0 of the previous record.  The records whose record number is a
+      multiple of the interval (key records) always use first difference so that a random read never has to go back
+      further than the last key record.
+
+
+      COMPATIBILITY NOTE: Libraries older than 3.37 would misread the records of a file that contains type 4 or type 5
+      packets ([RICE PACKETS] or [CROSS CHANNEL PACKETS] in the header) or T0 prediction flags ([T0 KEY INTERVAL],
+      version 3.21 and later).  A file created with czmil_set_cwf_rice_packets, czmil_set_cwf_cross_channel_packets, or
+      czmil_set_cwf_t0_key_interval has "CZMIL extended library V4.xx" in [VERSION] instead of "CZMIL library V3.xx"
+      (the minor version is still the library minor version).  Older libraries look for "CZMIL library" at the start of
+      the file so they refuse to open it (CZMIL_NOT_CZMIL_FILE_ERROR).  Files created without these have the normal
+      library version and are read by older libraries as before.
+
+
       IMPORTANT NOTE: The "bits" values listed above (e.g. num_packets_bits) are based on default values that are
       contained in the czmil_internals.h file.  These may change over time so they (or the information used to
       create them) are stored in the header (e.g. num_packets_bits is based on [CZMIL_MAX_PACKETS]).  To see how
@@ -767,9 +824,11 @@ extern "C" {
       file except that the CPF addresses and buffer sizes are set to zero.  When Optech creates the CPF file the
       CWI file will be read and a new CIF file will be created with the CPF addresses and buffer sizes populated.
       If the CIF file is ever lost or accidentally deleted, the API will regenerate it the next time the associated
-      CWF or CPF file is opened.  Like the other files, it has a tagged ASCII header.  Unlike the other files,
-      application defined fields are not supported since the CIF file doesn't contain anything other than buffer
-      sizes and byte addresses.  The following is an example header:
+      CWF or CPF file is opened.  The CWF and CPF files are scanned with large reads so this doesn't take much longer than
+      reading the two files.  If the library was compiled with OpenMP (NBMakefile uses -fopenmp) and czmil_set_thread_count
+      allows more than one thread the two files are scanned at the same time, otherwise one after the other.  Like the
+      other files, it has a tagged ASCII header.  Unlike the other files, application defined fields are not supported
+      since the CIF file doesn't contain anything other than buffer sizes and byte addresses.  The following is an example header:
 
       <pre>
       [VERSION] = CZMIL library V0.10 - 07/02/12
@@ -1064,21 +1123,38 @@ extern "C" {
 
 
       The CZMIL I/O library is thread safe if you follow some simple rules.  First, it is only thread safe if you use unique CZMIL
-      file handles per thread.  Also, the czmil_create_c*f, czmil_open_c*f, and czmil_close_c*f functions are not thread safe due
-      to the fact that they assign or clear the CZMIL file handles.  In order to use the library in multiple threads you must open
-      (or create) the CZMIL files prior to starting the threads and close them after the threads have completed.  Some common sense
-      must be brought to bear when trying to create a multithreaded program that works with CZMIL files.  When you are creating
-      files, threads should only work with one file.  So, for example, if you want to create 16 CWF files from 16 sets of raw data
-      you would open all 16 new CWF files using czmil_create_cwf_file prior to starting your threads.  After that, each thread would
-      append records to each of the files.  When the threads are finished you would use czmil_close_cwf_file to close each of the
-      new CWF files.
+      file handles per thread.  The czmil_create_c*f, czmil_open_c*f, and czmil_close_c*f functions (and
+      czmil_open_flightline_set and czmil_close_flightline_set) may be called from any thread at any time (see below) and they
+      don't get in the way of threads that are reading or writing records on handles that are already open.  Some common sense must be brought to bear when trying to
+      create a multithreaded program that works with CZMIL files.  When you are creating files, threads should only work with one
+      file.  So, for example, if you want to create 16 CWF files from 16 sets of raw data each thread would use czmil_create_cwf_file
+      to create its file, append records to it, and then use czmil_close_cwf_file to close it.
+
+      If you want multiple threads to read from multiple or single CZMIL files at the same time each thread needs its own CZMIL
+      file handle for each file.  You can get one by opening the file again in each thread, or, for CWF and CPF files that are
+      opened CZMIL_READONLY or CZMIL_READONLY_MMAP, open the file once and give each thread a cursor (see czmil_open_cpf_cursor and
+      czmil_open_cwf_cursor).  A cursor is a file handle that shares the open file, the parsed header, and the CIF index of the
+      original handle but reads with pread (or from the mapping) so it never moves the shared file pointer.  Only cursors read this
+      way.  The handle that the cursors were opened on still reads with fseek and fread (see czmil_fread in czmil.c) so it must not
+      be read from more than one thread at a time.  Opening a cursor doesn't read anything so 64 threads reading one big flightline
+      don't cost 64 full opens.  Cursors are closed with the normal close functions and they all have to be closed before the
+      original handle is closed.  The static data in the CZMIL API is segregated by the CZMIL file handle so there should be no
+      collision problems.  Just don't close a handle while another thread is still using it.  Every CPF and CWF handle that you
+      open has its own CIF index handle.  The only exception is a flightline set, where the CPF and CWF files share one, so a
+      flightline set handle must only be used by one thread at a time.
 
-      If you want multiple threads to read from multiple or single CZMIL files at the same time you must open each file for each
-      thread to get a separate CZMIL file handle for each file and thread.  The static data in the CZMIL API is segregated by the 
-      CZMIL file handle so there should be no collision problems.  Again, you have to open the files prior to starting your threads
-      and close them after the threads are finished.
+      The handle tables start out with CZMIL_MAX_FILES handles of each type and double in size whenever they fill up (up to
+      CZMIL_MAX_HANDLES, which is far more files than the system will let you open).  Handles are reused after they are closed so
+      the tables only get as big as the largest number of files that were open at the same time.  Opens and closes in different
+      threads run at the same time.  They only wait on each other long enough to get or give back a handle (or a pooled I/O
+      buffer) so an open that has to regenerate a CIF file (see czmil_create_cif_file) doesn't hold up anybody else.
 
-      In general, all of the public functions, with the exception of the create, opem, close, and error functions are thread safe.
+      The error information (czmil_get_errno, czmil_strerror, and czmil_perror) is kept per thread.  A thread always sees the
+      last error from its own calls, no matter what other threads are doing.  Call czmil_strerror or czmil_perror from the
+      thread that got the error.  For the errors that a reader can hit many times (invalid record numbers, reads past the end
+      of the file, and read failures) the message text isn't built until czmil_strerror or czmil_perror asks for it.
+
+      In general, all of the public functions are thread safe.
 
 
 
@@ -1114,6 +1190,22 @@ extern "C" {
       becomes a lot less cheap.  It also becomes a lot heavier.  The bottom line is that we're trading more memory for higher speed
       and less complexity.
 
+      If you're going to read a file randomly, or read it with a lot of threads, open it with CZMIL_READONLY_MMAP.  The file (and
+      its CIF file) is memory mapped and the records are decoded straight from the mapping.  There are no fseek/fread calls and no
+      setvbuf buffer, and the record array functions don't copy the compressed buffers at all.  The operating system's page cache
+      does all of the buffering so the memory it uses is shared by every process (and handle) reading the same file.
+
+      When a CPF or CWF file is opened CZMIL_READONLY (or CZMIL_UPDATE) the whole CIF index is read into memory at open (about 5.5
+      bytes per shot) so finding a record doesn't cost an extra read.  The total for all open files is limited by
+      czmil_set_cif_memory_budget (CZMIL_CIF_MEMORY_BUDGET by default).  Files that don't fit just read the index from disk.
+
+      The big I/O buffers used to create files (or open them CZMIL_READONLY_SEQUENTIAL) aren't freed when the file is closed.  They
+      go into a pool and the next create or open reuses them, so a program that processes thousands of flightlines one after the
+      other doesn't allocate and free tens of megabytes per file.  The pool is limited by czmil_set_io_buffer_budget
+      (CZMIL_IO_BUFFER_BUDGET by default, 0 turns it off).  The buffer size for a sequential open can be set with
+      czmil_open_cwf_file_with_buffer_size, czmil_open_cpf_file_with_buffer_size, or czmil_open_csf_file_with_buffer_size.  On
+      Linux, czmil_set_io_buffer_huge_pages (1) asks for the pooled buffers to be backed by transparent huge pages.
+
 
 
 
@@ -1328,6 +1420,35 @@ extern "C" {
   } CZMIL_CWF_Data;
 
 
+  /*!
+
+      Compact CZMIL Waveform File data structure.
+
+      This is an alternative to CZMIL_CWF_Data for programs that need to keep a lot of waveforms in memory.  Only the
+      populated packets are stored.  The samples, ranges, and packet numbers of all of the populated packets are stored
+      contiguously (channel by channel) in storage supplied by the caller to czmil_read_cwf_record_packed.  Packet j
+      (0 <= j < number_of_packets[i]) of channel i is packet number packet_offset[i] + j, so its 64 samples start at
+      samples[(packet_offset[i] + j) * 64], its range is range[packet_offset[i] + j], and its packet number is
+      channel_ndx[packet_offset[i] + j].
+
+  */
+
+  typedef struct
+  {
+    uint32_t             shot_id;                            /*!<  Shot ID number from MCWP.  */
+    uint64_t             timestamp;                          /*!<  Microseconds from January 01, 1970.  */
+    uint16_t             T0[64];                             /*!<  T0 waveform data.  */
+    float                scan_angle;                         /*!<  Scan angle (this will be normalized to 0-360 degrees by the API).  */
+    uint8_t              number_of_packets[9];               /*!<  Number of packets per channel.  */
+    uint8_t              packet_offset[9];                   /*!<  Index of the first packet of each channel.  */
+    uint16_t             total_packets;                      /*!<  Total number of packets in the record.  */
+    uint16_t             validity_reason[9];                 /*!< (0-15) Per channel waveform validity reason (see czmil_macros.h).  */
+    uint16_t             *samples;                           /*!<  total_packets * 64 samples.  */
+    float                *range;                             /*!<  total_packets MCWP range values.  */
+    uint8_t              *channel_ndx;                       /*!<  total_packets packet numbers.  */
+  } CZMIL_CWF_Packed_Data;
+
+
   /*!
 
       - CZMIL Point File per return data structure.  Key definitions are as follows:
@@ -1502,6 +1623,10 @@ extern "C" {
   /*!  CZMIL Public function declarations.  */
 
   CZMIL_DLL void czmil_register_progress_callback (CZMIL_PROGRESS_CALLBACK progressCB);
+  CZMIL_DLL void czmil_set_thread_count (int32_t threads);
+  CZMIL_DLL void czmil_set_cif_memory_budget (int64_t bytes);
+  CZMIL_DLL void czmil_set_io_buffer_budget (int64_t bytes);
+  CZMIL_DLL void czmil_set_io_buffer_huge_pages (int32_t on);
 
   CZMIL_DLL int32_t czmil_create_caf_file (char *path, CZMIL_CAF_Header *caf_header);
 
@@ -1509,6 +1634,12 @@ extern "C" {
   CZMIL_DLL int32_t czmil_open_cpf_file (const char *path, CZMIL_CPF_Header *cpf_header, int32_t mode);
   CZMIL_DLL int32_t czmil_open_csf_file (const char *path, CZMIL_CSF_Header *csf_header, int32_t mode);
   CZMIL_DLL int32_t czmil_open_caf_file (const char *path, CZMIL_CAF_Header *caf_header);
+  CZMIL_DLL int32_t czmil_open_cwf_file_with_buffer_size (const char *path, CZMIL_CWF_Header *cwf_header, int32_t mode, int32_t io_buffer_size);
+  CZMIL_DLL int32_t czmil_open_cpf_file_with_buffer_size (const char *path, CZMIL_CPF_Header *cpf_header, int32_t mode, int32_t io_buffer_size);
+  CZMIL_DLL int32_t czmil_open_csf_file_with_buffer_size (const char *path, CZMIL_CSF_Header *csf_header, int32_t mode, int32_t io_buffer_size);
+
+  CZMIL_DLL int32_t czmil_open_cwf_cursor (int32_t hnd);
+  CZMIL_DLL int32_t czmil_open_cpf_cursor (int32_t hnd);
 
   CZMIL_DLL int32_t czmil_close_cwf_file (int32_t hnd);
   CZMIL_DLL int32_t czmil_close_cpf_file (int32_t hnd);
@@ -1516,13 +1647,30 @@ extern "C" {
   CZMIL_DLL int32_t czmil_close_caf_file (int32_t hnd);
 
   CZMIL_DLL int32_t czmil_read_cwf_record_array (int32_t hnd, int32_t recnum, int32_t num_requested, CZMIL_CWF_Data *record_array);
+  CZMIL_DLL int32_t czmil_read_cwf_records_by_index (int32_t hnd, int32_t count, const int32_t *recnums, CZMIL_CWF_Data *record_array);
   CZMIL_DLL int32_t czmil_read_cwf_record (int32_t hnd, int32_t recnum, CZMIL_CWF_Data *record);
+  CZMIL_DLL int32_t czmil_read_cwf_record_channels (int32_t hnd, int32_t recnum, uint32_t channel_mask, CZMIL_CWF_Data *record);
+  CZMIL_DLL int32_t czmil_read_cwf_record_packed (int32_t hnd, int32_t recnum, uint32_t channel_mask, CZMIL_CWF_Packed_Data *record,
+                                                  uint8_t *storage, int32_t storage_size);
+  CZMIL_DLL int32_t czmil_read_cwf_record_packed_array (int32_t hnd, int32_t recnum, int32_t num_requested, uint32_t channel_mask,
+                                                        CZMIL_CWF_Packed_Data *record_array, uint8_t *storage, int32_t storage_size,
+                                                        int32_t *storage_used);
   CZMIL_DLL int32_t czmil_read_cpf_record_array (int32_t hnd, int32_t recnum, int32_t num_requested, CZMIL_CPF_Data *record_array);
+  CZMIL_DLL int32_t czmil_read_cpf_records_by_index (int32_t hnd, int32_t count, const int32_t *recnums, CZMIL_CPF_Data *record_array);
   CZMIL_DLL int32_t czmil_read_cpf_record (int32_t hnd, int32_t recnum, CZMIL_CPF_Data *record);
   CZMIL_DLL int32_t czmil_read_csf_record_array (int32_t hnd, int32_t recnum, int32_t num_requested, CZMIL_CSF_Data *record_array);
   CZMIL_DLL int32_t czmil_read_csf_record (int32_t hnd, int32_t recnum, CZMIL_CSF_Data *record);
   CZMIL_DLL int32_t czmil_read_caf_record (int32_t hnd, CZMIL_CAF_Data *record);
 
+  CZMIL_DLL int32_t czmil_open_flightline_set (const char *path, CZMIL_CPF_Header *cpf_header, CZMIL_CWF_Header *cwf_header,
+                                               CZMIL_CSF_Header *csf_header, int32_t mode);
+  CZMIL_DLL int32_t czmil_close_flightline_set (int32_t hnd);
+  CZMIL_DLL void czmil_get_flightline_set_handles (int32_t hnd, int32_t *cpf_hnd, int32_t *cwf_hnd, int32_t *csf_hnd);
+  CZMIL_DLL int32_t czmil_read_shot (int32_t hnd, int32_t recnum, CZMIL_CPF_Data *cpf_record, CZMIL_CWF_Data *cwf_record,
+                                     CZMIL_CSF_Data *csf_record);
+  CZMIL_DLL int32_t czmil_read_shot_array (int32_t hnd, int32_t recnum, int32_t num_requested, CZMIL_CPF_Data *cpf_array,
+                                           CZMIL_CWF_Data *cwf_array, CZMIL_CSF_Data *csf_array);
+
   CZMIL_DLL int32_t czmil_write_caf_record (int32_t hnd, CZMIL_CAF_Data *record);
 
   CZMIL_DLL int32_t czmil_update_cpf_record (int32_t hnd, int32_t recnum, CZMIL_CPF_Data *record);
@@ -135,43 +135,43 @@ static void czmil_clean_exit (int32_t ret)
 {
   int32_t i;
 
-  for (i = 0 ; i < CZMIL_MAX_FILES ; i++)
+  for (i = 0 ; i < czmil_max_files ; i++)
     {
       /*  If we were in the process of creating a file we need to remove it since it isn't finished.  */
 
-      if (cpf[i].fp != NULL)
+      if (cpf[i]->fp != NULL)
         {
-          if (cpf[i].created)
+          if (cpf[i]->created)
             {
-              fclose (cpf[i].fp);
-              remove (cpf[i].path);
+              fclose (cpf[i]->fp);
+              remove (cpf[i]->path);
             }
         }
 
-      if (cwf[i].fp != NULL)
+      if (cwf[i]->fp != NULL)
         {
-          if (cwf[i].created)
+          if (cwf[i]->created)
             {
-              fclose (cwf[i].fp);
-              remove (cwf[i].path);
+              fclose (cwf[i]->fp);
+              remove (cwf[i]->path);
             }
         }
 
-      if (csf[i].fp != NULL)
+      if (csf[i]->fp != NULL)
         {
-          if (csf[i].created)
+          if (csf[i]->created)
             {
-              fclose (csf[i].fp);
-              remove (csf[i].path);
+              fclose (csf[i]->fp);
+              remove (csf[i]->path);
             }
         }
 
-      if (cif[i].fp != NULL)
+      if (cif[i]->fp != NULL)
         {
-          if (cif[i].created)
+          if (cif[i]->created)
             {
-              fclose (cif[i].fp);
-              remove (cif[i].path);
+              fclose (cif[i]->fp);
+              remove (cif[i]->path);
             }
         }
     }
@@ -302,6 +302,49 @@ static void czmil_get_string (const char *in, char *out)
 
 
 
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_gmtime
+
+ - Purpose:     Thread safe gmtime.
+
+ - Author:      PFM Software
+
+ - Date:        10/17/26
+
+ - Arguments:
+                - t               =   Time to convert
+
+ - Returns:
+                - Pointer to the broken down time or NULL on failure
+
+ - Caveats:     gmtime returns a pointer to one static structure.  The create and close
+                functions can run in different threads at the same time (see
+                czmil_lock_handles) so each thread gets its own structure here.  It's
+                overwritten by the next call in the same thread just like gmtime's.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+static struct tm *czmil_gmtime (const time_t *t)
+{
+  static CZMIL_THREAD_LOCAL struct tm tm;
+
+
+#ifdef _WIN32
+  if (gmtime_s (&tm, t)) return (NULL);
+
+  return (&tm);
+#else
+  return (gmtime_r (t, &tm));
+#endif
+}
+
+
+
 /*******************************************************************************************/
 /*!
 
@@ -750,6 +793,1823 @@ CZMIL_INLINE uint64_t czmil_double_bit_unpack (uint8_t buffer[], uint32_t start,
 
 
 
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_bit_reader_refill
+
+ - Purpose:     Tops up the accumulator of a CZMIL_BIT_READER so that it holds at least
+                57 valid bits (or everything that is left in the buffer).  When there are
+                at least 8 bytes left in the buffer we load all 8 of them at once, big
+                endian, and only count the whole bytes that fit.  The bits below the valid
+                bits in the accumulator are always either zero or the correct stream bits so
+                ORing the same bits in again on the next refill doesn't hurt anything.  Near
+                the end of the buffer we fall back to loading a byte at a time.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER
+
+ - Returns:
+                - void
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_bit_reader_refill (CZMIL_BIT_READER *reader)
+{
+  const uint8_t *ptr;
+
+
+  if (reader->pos + 8 <= reader->size)
+    {
+      ptr = &reader->buffer[reader->pos];
+
+      reader->acc |= (((uint64_t) ptr[0] << 56) | ((uint64_t) ptr[1] << 48) | ((uint64_t) ptr[2] << 40) | ((uint64_t) ptr[3] << 32) |
+                      ((uint64_t) ptr[4] << 24) | ((uint64_t) ptr[5] << 16) | ((uint64_t) ptr[6] << 8) | (uint64_t) ptr[7]) >> reader->bits;
+
+      reader->pos += (63 - reader->bits) >> 3;
+      reader->bits |= 56;
+    }
+  else
+    {
+      while (reader->bits <= 56 && reader->pos < reader->size)
+        {
+          reader->acc |= (uint64_t) reader->buffer[reader->pos++] << (56 - reader->bits);
+          reader->bits += 8;
+        }
+    }
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_bit_reader_init
+
+ - Purpose:     Sets up a CZMIL_BIT_READER cursor so that we can read consecutive fields
+                from a bit-packed buffer starting at bit position 'start'.  This replaces
+                the old czmil_bit_unpack/bpos += numbits pairs in the record decoders.
+                The bits come out in exactly the same order as czmil_bit_unpack would
+                return them.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER to be initialized
+                - buffer          =   pointer to uint8_t buffer to unpack values from
+                - size            =   number of valid bytes in the buffer
+                - start           =   start bit position in the buffer
+
+ - Returns:
+                - void
+
+ - Caveats:     The reader will never touch a byte at or past 'size'.  If a corrupt record
+                asks for more bits than are in the buffer the missing bits are returned as
+                zeros.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_bit_reader_init (CZMIL_BIT_READER *reader, const uint8_t buffer[], uint32_t size, uint32_t start)
+{
+  reader->buffer = buffer;
+  reader->size = size;
+  reader->pos = start >> 3;
+  reader->acc = 0;
+  reader->bits = 0;
+
+  if (reader->pos > reader->size) reader->pos = reader->size;
+
+  czmil_bit_reader_refill (reader);
+
+
+  /*  Drop the leading bits of the first byte if we didn't start on a byte boundary.  */
+
+  if ((start & 7) && reader->bits)
+    {
+      reader->acc <<= (start & 7);
+      reader->bits -= (start & 7);
+    }
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_bit_read
+
+ - Purpose:     Reads the next 'numbits' bits from a CZMIL_BIT_READER as an unsigned, 32 bit
+                value and advances the cursor.  This returns the same value that
+                czmil_bit_unpack would return for the same bit position.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER
+                - numbits         =   number of bits to retrieve (0 to 32)
+
+ - Returns:
+                - value           =   unsigned, 32 bit integer value retrieved from the buffer
+
+ - Caveats:     Just like czmil_bit_unpack, the value is not sign extended.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE uint32_t czmil_bit_read (CZMIL_BIT_READER *reader, uint32_t numbits)
+{
+  uint32_t               value;
+
+
+  /*  Some of the CWF packets have a delta_bits value of 0 (all of the deltas are the same).  */
+
+  if (!numbits) return (0);
+
+
+  if (reader->bits < (int32_t) numbits)
+    {
+      czmil_bit_reader_refill (reader);
+
+
+      /*  If we ran out of buffer, pad with zeros.  */
+
+      if (reader->bits < (int32_t) numbits) reader->bits = numbits;
+    }
+
+
+  value = (uint32_t) (reader->acc >> (64 - numbits));
+
+  reader->acc <<= numbits;
+  reader->bits -= numbits;
+
+  return (value);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_double_bit_read
+
+ - Purpose:     Reads the next 'numbits' bits from a CZMIL_BIT_READER as an unsigned, 64 bit
+                value and advances the cursor.  This is the cursor equivalent of
+                czmil_double_bit_unpack.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER
+                - numbits         =   number of bits to retrieve
+
+ - Returns:
+                - value           =   unsigned, 64 bit integer value retrieved from the buffer
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+                <b>NEVER call this function with numbits less than 33!</b>
+
+*********************************************************************************************/
+
+CZMIL_INLINE uint64_t czmil_double_bit_read (CZMIL_BIT_READER *reader, uint32_t numbits)
+{
+  uint64_t          result;
+
+
+  result = ((uint64_t) czmil_bit_read (reader, numbits - 32)) << 32;
+  result |= (uint64_t) czmil_bit_read (reader, 32);
+
+  return (result);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_bit_skip
+
+ - Purpose:     Skips over the next 'numbits' bits in a CZMIL_BIT_READER.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER
+                - numbits         =   number of bits to skip
+
+ - Returns:
+                - void
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_bit_skip (CZMIL_BIT_READER *reader, uint32_t numbits)
+{
+  while (numbits > 32)
+    {
+      czmil_bit_read (reader, 32);
+      numbits -= 32;
+    }
+
+  czmil_bit_read (reader, numbits);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_bit_writer_init
+
+ - Purpose:     Sets up a CZMIL_BIT_WRITER cursor so that we can append consecutive fields
+                to a bit-packed buffer starting at bit position 'start'.  This replaces
+                the old czmil_bit_pack/bpos += numbits pairs in the record encoders.  Any
+                bits in the first byte that are ahead of 'start' are left alone, just like
+                czmil_bit_pack would.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - writer          =   pointer to the CZMIL_BIT_WRITER to be initialized
+                - buffer          =   pointer to uint8_t buffer to pack values into
+                - start           =   start bit position in the buffer
+
+ - Returns:
+                - void
+
+ - Caveats:     Nothing is guaranteed to be in the buffer until czmil_bit_writer_flush has
+                been called.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_bit_writer_init (CZMIL_BIT_WRITER *writer, uint8_t buffer[], uint32_t start)
+{
+  writer->buffer = buffer;
+  writer->pos = start >> 3;
+  writer->bits = start & 7;
+  writer->acc = 0;
+
+
+  /*  Carry the leading bits of the first byte along if we didn't start on a byte boundary.  */
+
+  if (writer->bits) writer->acc = (uint64_t) (buffer[writer->pos] & mask[writer->bits]) << 56;
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_bit_write
+
+ - Purpose:     Appends the low order 'numbits' bits of 'value' to a CZMIL_BIT_WRITER.  When
+                the accumulator can't hold the new field we store the oldest 32 bits to the
+                buffer (big endian) in one shot.  The resulting bit stream is identical to
+                what czmil_bit_pack would have produced for the same fields.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - writer          =   pointer to the CZMIL_BIT_WRITER
+                - numbits         =   number of bits to store (0 to 32)
+                - value           =   unsigned, 32 bit integer number to store in the buffer
+
+ - Returns:
+                - void
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_bit_write (CZMIL_BIT_WRITER *writer, uint32_t numbits, int32_t value)
+{
+  uint64_t               bits;
+  uint8_t                *ptr;
+
+
+  /*  Some of the CWF packets have a delta_bits value of 0 (all of the deltas are the same).  */
+
+  if (!numbits) return;
+
+
+  bits = (uint64_t) ((uint32_t) value) & (UINT64_MAX >> (64 - numbits));
+
+
+  if (writer->bits > 32)
+    {
+      ptr = &writer->buffer[writer->pos];
+
+      ptr[0] = (uint8_t) (writer->acc >> 56);
+      ptr[1] = (uint8_t) (writer->acc >> 48);
+      ptr[2] = (uint8_t) (writer->acc >> 40);
+      ptr[3] = (uint8_t) (writer->acc >> 32);
+
+      writer->pos += 4;
+      writer->acc <<= 32;
+      writer->bits -= 32;
+    }
+
+
+  writer->acc |= bits << (64 - writer->bits - numbits);
+  writer->bits += numbits;
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_double_bit_write
+
+ - Purpose:     Appends the low order 'numbits' bits of the 64 bit 'value' to a
+                CZMIL_BIT_WRITER.  This is the cursor equivalent of czmil_double_bit_pack.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - writer          =   pointer to the CZMIL_BIT_WRITER
+                - numbits         =   number of bits to store
+                - value           =   unsigned, 64 bit integer number to store in the buffer
+
+ - Returns:
+                - void
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+                <b>NEVER call this function with numbits less than 33!</b>
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_double_bit_write (CZMIL_BIT_WRITER *writer, uint32_t numbits, int64_t value)
+{
+  czmil_bit_write (writer, numbits - 32, (int32_t) (((uint64_t) value) >> 32));
+  czmil_bit_write (writer, 32, (int32_t) (value & UINT32_MAX));
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_bit_writer_flush
+
+ - Purpose:     Stores whatever is left in the accumulator of a CZMIL_BIT_WRITER to the
+                buffer.  Any bits in the last byte that are past the end of the last field
+                are set to zero so that the output doesn't depend on what was in the buffer
+                before (unlike czmil_bit_pack, which leaves them alone).
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - writer          =   pointer to the CZMIL_BIT_WRITER
+
+ - Returns:
+                - The total number of bits written to the buffer (including the 'start'
+                  bits passed to czmil_bit_writer_init).  This is the same as the old
+                  bpos value.
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE uint32_t czmil_bit_writer_flush (CZMIL_BIT_WRITER *writer)
+{
+  while (writer->bits >= 8)
+    {
+      writer->buffer[writer->pos++] = (uint8_t) (writer->acc >> 56);
+      writer->acc <<= 8;
+      writer->bits -= 8;
+    }
+
+
+  /*  Store the partial last byte.  The bits past the end of the last field are always zero in the accumulator.  */
+
+  if (writer->bits) writer->buffer[writer->pos] = (uint8_t) (writer->acc >> 56);
+
+
+  return (writer->pos * 8 + writer->bits);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_bit_reader_tell
+
+ - Purpose:     Returns the bit position in the buffer of the next bit that will be read from
+                a CZMIL_BIT_READER.  This is the bpos that the old czmil_bit_unpack code would
+                have been using at this point.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER
+
+ - Returns:
+                - bit position
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE uint32_t czmil_bit_reader_tell (CZMIL_BIT_READER *reader)
+{
+  return (reader->pos * 8 - reader->bits);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_bit_read_array
+
+ - Purpose:     Reads 'count' consecutive, fixed width fields from a CZMIL_BIT_READER.  This
+                returns the same values as calling czmil_bit_read 'count' times but it only
+                refills the accumulator once for every 56 / numbits fields.  When this is
+                called with a constant numbits (see CZMIL_UNPACK_KERNEL) the compiler
+                turns it into a width specialized kernel with no width dependent branching
+                in the inner loop.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER
+                - count           =   number of fields to read
+                - numbits         =   number of bits in each field (0 to 32)
+                - values          =   unsigned, 32 bit output values
+
+ - Returns:
+                - void
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_bit_read_array (CZMIL_BIT_READER *reader, int32_t count, uint32_t numbits, uint32_t *values)
+{
+  int32_t                i, k, per;
+
+
+  if (!numbits)
+    {
+      for (k = 0 ; k < count ; k++) values[k] = 0;
+      return;
+    }
+
+
+  /*  The fast refill always leaves at least 56 valid bits in the accumulator so we can pull this many fields out
+      of it without checking.  */
+
+  per = 56 / numbits;
+
+  k = 0;
+  while (count - k >= per && reader->pos + 8 <= reader->size)
+    {
+      czmil_bit_reader_refill (reader);
+
+      for (i = 0 ; i < per ; i++)
+        {
+          values[k++] = (uint32_t) (reader->acc >> (64 - numbits));
+          reader->acc <<= numbits;
+        }
+
+      reader->bits -= per * numbits;
+    }
+
+
+  /*  Whatever is left over (or anything near the end of the buffer) goes through the checked read.  */
+
+  for ( ; k < count ; k++) values[k] = czmil_bit_read (reader, numbits);
+}
+
+
+
+/*  Width specialized unpack kernels.  Each of these is czmil_bit_read_array with the width fixed at compile time.  */
+
+#define CZMIL_UNPACK_KERNEL(n) \
+  static void czmil_unpack_##n (CZMIL_BIT_READER *reader, int32_t count, uint32_t *values) \
+  { \
+    czmil_bit_read_array (reader, count, n, values); \
+  }
+
+CZMIL_UNPACK_KERNEL (0)
+CZMIL_UNPACK_KERNEL (1)
+CZMIL_UNPACK_KERNEL (2)
+CZMIL_UNPACK_KERNEL (3)
+CZMIL_UNPACK_KERNEL (4)
+CZMIL_UNPACK_KERNEL (5)
+CZMIL_UNPACK_KERNEL (6)
+CZMIL_UNPACK_KERNEL (7)
+CZMIL_UNPACK_KERNEL (8)
+CZMIL_UNPACK_KERNEL (9)
+CZMIL_UNPACK_KERNEL (10)
+CZMIL_UNPACK_KERNEL (11)
+CZMIL_UNPACK_KERNEL (12)
+CZMIL_UNPACK_KERNEL (13)
+CZMIL_UNPACK_KERNEL (14)
+CZMIL_UNPACK_KERNEL (15)
+CZMIL_UNPACK_KERNEL (16)
+CZMIL_UNPACK_KERNEL (17)
+CZMIL_UNPACK_KERNEL (18)
+CZMIL_UNPACK_KERNEL (19)
+CZMIL_UNPACK_KERNEL (20)
+CZMIL_UNPACK_KERNEL (21)
+CZMIL_UNPACK_KERNEL (22)
+CZMIL_UNPACK_KERNEL (23)
+CZMIL_UNPACK_KERNEL (24)
+CZMIL_UNPACK_KERNEL (25)
+CZMIL_UNPACK_KERNEL (26)
+CZMIL_UNPACK_KERNEL (27)
+CZMIL_UNPACK_KERNEL (28)
+CZMIL_UNPACK_KERNEL (29)
+CZMIL_UNPACK_KERNEL (30)
+CZMIL_UNPACK_KERNEL (31)
+CZMIL_UNPACK_KERNEL (32)
+
+static const CZMIL_UNPACK_FUNC czmil_unpack_kernel[33] =
+  {czmil_unpack_0, czmil_unpack_1, czmil_unpack_2, czmil_unpack_3, czmil_unpack_4, czmil_unpack_5, czmil_unpack_6, czmil_unpack_7,
+   czmil_unpack_8, czmil_unpack_9, czmil_unpack_10, czmil_unpack_11, czmil_unpack_12, czmil_unpack_13, czmil_unpack_14, czmil_unpack_15,
+   czmil_unpack_16, czmil_unpack_17, czmil_unpack_18, czmil_unpack_19, czmil_unpack_20, czmil_unpack_21, czmil_unpack_22, czmil_unpack_23,
+   czmil_unpack_24, czmil_unpack_25, czmil_unpack_26, czmil_unpack_27, czmil_unpack_28, czmil_unpack_29, czmil_unpack_30, czmil_unpack_31,
+   czmil_unpack_32};
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_unpack_select
+
+ - Purpose:     Returns the width specialized unpack kernel for 'numbits' wide fields.  This
+                is called once per packet (for the CWF delta_bits) or once per handle on
+                open/create (for the fixed header field widths) so that the unpack loops
+                themselves never have to look at the width.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - numbits         =   number of bits in each field (0 to 32)
+
+ - Returns:
+                - CZMIL_UNPACK_FUNC
+
+ - Caveats:     czmil_bit_read can't return more than 32 bits so a (corrupt) width larger
+                than that is clamped to 32.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE CZMIL_UNPACK_FUNC czmil_unpack_select (uint32_t numbits)
+{
+  if (numbits > 32) numbits = 32;
+
+  return (czmil_unpack_kernel[numbits]);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_bit_read_unary
+
+ - Purpose:     Reads a unary code (a run of 1 bits terminated by a 0 bit) from a
+                CZMIL_BIT_READER and returns the number of 1 bits.  If we see 'limit' 1
+                bits in a row we stop and return 'limit' without reading a terminator.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER
+                - limit           =   maximum run length (no more than 32)
+
+ - Returns:
+                - number of 1 bits (0 to limit)
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE uint32_t czmil_bit_read_unary (CZMIL_BIT_READER *reader, uint32_t limit)
+{
+  uint32_t               count;
+  uint64_t               ones;
+
+
+  if (reader->bits <= (int32_t) limit)
+    {
+      czmil_bit_reader_refill (reader);
+
+
+      /*  If we ran out of buffer, pad with zeros.  */
+
+      if (reader->bits <= (int32_t) limit) reader->bits = limit + 1;
+    }
+
+
+  /*  Count the leading 1 bits.  */
+
+  ones = ~reader->acc;
+
+#if (defined __GNUC__)
+  count = ones ? __builtin_clzll (ones) : 64;
+#else
+  for (count = 0 ; count < limit && !(ones & (0x8000000000000000ULL >> count)) ; count++);
+#endif
+
+  if (count >= limit)
+    {
+      count = limit;
+      reader->acc <<= limit;
+      reader->bits -= limit;
+    }
+  else
+    {
+      reader->acc <<= count + 1;
+      reader->bits -= count + 1;
+    }
+
+  return (count);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_rice_param
+
+ - Purpose:     Computes the adaptive Rice parameter for the next value of a
+                CZMIL_RICE_DIFFERENCE packet.  This is the smallest k for which the
+                running count times 2^k is at least the running sum of the (zigzag
+                encoded) values.  In other words, 2^k is about the running mean.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - sum             =   running sum of the zigzag encoded values
+                - count           =   running count
+
+ - Returns:
+                - Rice parameter
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE uint32_t czmil_rice_param (uint32_t sum, uint32_t count)
+{
+  uint32_t               k;
+
+
+  for (k = 0 ; (count << k) < sum ; k++);
+
+  return (k);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_rice_size
+
+ - Purpose:     Computes the number of bits needed to store 'count' first differences as a
+                CZMIL_RICE_DIFFERENCE packet (not counting the packet header) and picks
+                the initial Rice parameter.  The Rice parameter then adapts to the running
+                mean of the values so a spike only costs a few bits on the following
+                values instead of widening every value in the packet.  Values that would
+                need a unary prefix of CWF_RICE_ESCAPE or more bits are stored as
+                CWF_RICE_RAW_BITS bit raw values after an escape prefix.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - delta           =   first differences
+                - count           =   number of first differences
+                - k0              =   returned initial Rice parameter
+
+ - Returns:
+                - number of bits or...
+                - -1 if the differences are too big to store this way
+
+ - Caveats:     This must be kept in sync with czmil_rice_encode and czmil_rice_decode.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE int32_t czmil_rice_size (const int16_t *delta, int32_t count, uint32_t *k0)
+{
+  int32_t                i, bits;
+  uint32_t               k, z, q, sum, n;
+
+
+  /*  Start with the mean of the first few values.  */
+
+  for (i = 0, sum = 0 ; i < CWF_RICE_WINDOW / 2 && i < count ; i++) sum += CZMIL_ZIGZAG (delta[i]);
+
+  *k0 = czmil_rice_param (sum, CWF_RICE_WINDOW / 2);
+
+  sum = 2 << *k0;
+  n = 2;
+
+  bits = 0;
+  for (i = 0 ; i < count ; i++)
+    {
+      z = CZMIL_ZIGZAG (delta[i]);
+
+      if (z >> CWF_RICE_RAW_BITS) return (-1);
+
+      k = czmil_rice_param (sum, n);
+      q = z >> k;
+
+      if (q < CWF_RICE_ESCAPE)
+        {
+          bits += q + 1 + k;
+        }
+      else
+        {
+          bits += CWF_RICE_ESCAPE + CWF_RICE_RAW_BITS;
+        }
+
+      sum += z;
+      if (++n == CWF_RICE_WINDOW)
+        {
+          sum >>= 1;
+          n >>= 1;
+        }
+    }
+
+  return (bits);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_rice_encode
+
+ - Purpose:     Writes 'count' first differences to a CZMIL_BIT_WRITER as adaptive Rice
+                codes (see czmil_rice_size).
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - writer          =   pointer to the CZMIL_BIT_WRITER
+                - delta           =   first differences
+                - count           =   number of first differences
+                - k0              =   initial Rice parameter from czmil_rice_size
+
+ - Returns:
+                - void
+
+ - Caveats:     Only call this if czmil_rice_size didn't return -1.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_rice_encode (CZMIL_BIT_WRITER *writer, const int16_t *delta, int32_t count, uint32_t k0)
+{
+  int32_t                i;
+  uint32_t               k, z, q, sum, n;
+
+
+  sum = 2 << k0;
+  n = 2;
+
+  for (i = 0 ; i < count ; i++)
+    {
+      z = CZMIL_ZIGZAG (delta[i]);
+      k = czmil_rice_param (sum, n);
+      q = z >> k;
+
+
+      /*  q 1 bits and a 0 bit followed by the low k bits, or the escape prefix followed by the raw value.  */
+
+      if (q < CWF_RICE_ESCAPE)
+        {
+          czmil_bit_write (writer, q + 1, (1 << (q + 1)) - 2);
+          czmil_bit_write (writer, k, z & ((1 << k) - 1));
+        }
+      else
+        {
+          czmil_bit_write (writer, CWF_RICE_ESCAPE, (1 << CWF_RICE_ESCAPE) - 1);
+          czmil_bit_write (writer, CWF_RICE_RAW_BITS, z);
+        }
+
+      sum += z;
+      if (++n == CWF_RICE_WINDOW)
+        {
+          sum >>= 1;
+          n >>= 1;
+        }
+    }
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_rice_decode
+
+ - Purpose:     Reads 'count' adaptive Rice coded first differences (see czmil_rice_size)
+                from a CZMIL_BIT_READER and integrates them starting at 'start'.  On
+                return, values[0] is 'start' and values[k] is values[k - 1] plus
+                delta k - 1.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER
+                - count           =   number of first differences
+                - k0              =   initial Rice parameter
+                - start           =   start value
+                - values          =   count + 1 output values
+
+ - Returns:
+                - void
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_rice_decode (CZMIL_BIT_READER *reader, int32_t count, uint32_t k0, int16_t start, uint16_t *values)
+{
+  int32_t                i;
+  uint32_t               k, z, q, sum, n;
+  int16_t                previous;
+
+
+  values[0] = previous = start;
+
+  sum = 2 << k0;
+  n = 2;
+
+  for (i = 1 ; i <= count ; i++)
+    {
+      k = czmil_rice_param (sum, n);
+      q = czmil_bit_read_unary (reader, CWF_RICE_ESCAPE);
+
+      if (q < CWF_RICE_ESCAPE)
+        {
+          z = (q << k) | czmil_bit_read (reader, k);
+        }
+      else
+        {
+          z = czmil_bit_read (reader, CWF_RICE_RAW_BITS);
+        }
+
+      values[i] = previous + CZMIL_UNZIGZAG (z);
+      previous = values[i];
+
+      sum += z;
+      if (++n == CWF_RICE_WINDOW)
+        {
+          sum >>= 1;
+          n >>= 1;
+        }
+    }
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_simd_level
+
+ - Purpose:     Determines (once) which SIMD instruction set we can use for the waveform
+                decode kernels.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:   N/A
+
+ - Returns:
+                - CZMIL_SIMD_NONE
+                - CZMIL_SIMD_SSE42
+                - CZMIL_SIMD_AVX2
+
+ - Caveats:     If the library wasn't built for x86 with a GCC compatible compiler (or was built
+                with CZMIL_NO_SIMD defined) this always returns CZMIL_SIMD_NONE.  This can be
+                called from more than one thread at a time.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE int32_t czmil_simd_level ()
+{
+#ifdef CZMIL_X86_SIMD
+  int32_t                level;
+
+
+  /*  Every thread that gets here first comes up with the same answer so it doesn't matter which store wins.  */
+
+  if ((level = __atomic_load_n (&czmil_simd, __ATOMIC_RELAXED)) < 0)
+    {
+      __builtin_cpu_init ();
+
+      if (__builtin_cpu_supports ("avx2"))
+        {
+          level = CZMIL_SIMD_AVX2;
+        }
+      else if (__builtin_cpu_supports ("sse4.2"))
+        {
+          level = CZMIL_SIMD_SSE42;
+        }
+      else
+        {
+          level = CZMIL_SIMD_NONE;
+        }
+
+      __atomic_store_n (&czmil_simd, level, __ATOMIC_RELAXED);
+    }
+
+  return (level);
+#else
+  return (CZMIL_SIMD_NONE);
+#endif
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_delta_decode_scalar
+
+ - Purpose:     Reads 'count' fixed width deltas from a CZMIL_BIT_READER, removes the offset
+                from each of them, and integrates them starting at 'start'.  On return,
+                values[0] is 'start' and values[k] is values[k - 1] plus delta k - 1.  This
+                is the inner loop of the CZMIL_FIRST_DIFFERENCE and CZMIL_SECOND_DIFFERENCE
+                packet decoders.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER
+                - count           =   number of deltas to read
+                - delta_bits      =   number of bits used to store each delta
+                - offset          =   offset to be removed from each delta
+                - start           =   start value
+                - values          =   count + 1 output values
+
+ - Returns:
+                - void
+
+ - Caveats:     'count' may not be larger than 64.
+
+                All of the arithmetic is done modulo 2^16, exactly like the original int16_t
+                and uint16_t code.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_delta_decode_scalar (CZMIL_BIT_READER *reader, int32_t count, int32_t delta_bits, int16_t offset, int16_t start,
+                                             uint16_t *values)
+{
+  int32_t                k;
+  int16_t                previous;
+  uint32_t               raw[64];
+
+
+  /*  Pick the unpack kernel for this packet's delta width once, then just integrate.  */
+
+  (*czmil_unpack_select (delta_bits)) (reader, count, raw);
+
+  values[0] = previous = start;
+
+  for (k = 1 ; k <= count ; k++)
+    {
+      values[k] = (int16_t) (raw[k - 1] - offset) + previous;
+      previous = values[k];
+    }
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_prefix_sum_scalar
+
+ - Purpose:     Integrates 'count' already unpacked deltas starting at 'start'.  On return,
+                values[0] is 'start' and values[k] is values[k - 1] plus delta[k - 1].  This
+                is used to turn the first differences of a CZMIL_SECOND_DIFFERENCE packet
+                into waveform values.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - count           =   number of deltas
+                - delta           =   deltas
+                - start           =   start value
+                - values          =   count + 1 output values
+
+ - Returns:
+                - void
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_prefix_sum_scalar (int32_t count, const int16_t *delta, int16_t start, uint16_t *values)
+{
+  int32_t                k;
+  int16_t                previous;
+
+
+  values[0] = previous = start;
+
+  for (k = 1 ; k <= count ; k++)
+    {
+      values[k] = delta[k - 1] + previous;
+      previous = values[k];
+    }
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_cwf_packet_analysis_scalar
+
+ - Purpose:     Computes the first differences, second differences, and (optionally) the
+                differences from the shallow central channel of a 64 sample CWF packet along
+                with the minimum and maximum value of each.  These are all that
+                czmil_compress_cwf_record needs to figure out which compression type will
+                give the smallest packet.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - packet          =   64 waveform samples
+                - central         =   64 samples of the corresponding shallow central channel
+                                      packet or NULL if we're not checking type 3
+                - delta           =   returned first differences (63 used, room for 64)
+                - delta2          =   returned second differences (62 used, room for 64)
+                - delta3          =   returned shallow central differences (64, only set if
+                                      central is not NULL)
+                - min_delta       =   returned minimum values, indexed by compression type (1
+                                      through 3)
+                - max_delta       =   returned maximum values, indexed by compression type (1
+                                      through 3)
+
+ - Returns:
+                - void
+
+ - Caveats:     All of the differences are computed modulo 2^16 and compared as signed 16 bit
+                values just like the original int16_t code.  The second differences are
+                computed from the first differences without the first difference offset applied
+                (the offset cancels out).
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_cwf_packet_analysis_scalar (const uint16_t *packet, const uint16_t *central, int16_t *delta, int16_t *delta2,
+                                                    int16_t *delta3, int16_t *min_delta, int16_t *max_delta)
+{
+  int32_t                k;
+
+
+  min_delta[1] = min_delta[2] = min_delta[3] = 32767;
+  max_delta[1] = max_delta[2] = max_delta[3] = -32768;
+
+  for (k = 0 ; k < 63 ; k++)
+    {
+      delta[k] = packet[k + 1] - packet[k];
+      min_delta[1] = MIN (delta[k], min_delta[1]);
+      max_delta[1] = MAX (delta[k], max_delta[1]);
+    }
+
+  for (k = 0 ; k < 62 ; k++)
+    {
+      delta2[k] = delta[k + 1] - delta[k];
+      min_delta[2] = MIN (delta2[k], min_delta[2]);
+      max_delta[2] = MAX (delta2[k], max_delta[2]);
+    }
+
+  if (central != NULL)
+    {
+      for (k = 0 ; k < 64 ; k++)
+        {
+          delta3[k] = packet[k] - central[k];
+          min_delta[3] = MIN (delta3[k], min_delta[3]);
+          max_delta[3] = MAX (delta3[k], max_delta[3]);
+        }
+    }
+}
+
+
+
+#ifdef CZMIL_X86_SIMD
+
+#include <immintrin.h>
+
+#define CZMIL_TARGET_SSE42 __attribute__ ((target ("sse4.2")))
+#define CZMIL_TARGET_AVX2 __attribute__ ((target ("avx2")))
+
+
+/*  Inclusive prefix sum of eight 16 bit lanes.  The carry from the previous eight is added by the caller so that the only
+    serial dependency from one set of eight to the next is a single add.  */
+
+CZMIL_TARGET_SSE42 CZMIL_INLINE __m128i czmil_prefix8_sse42 (__m128i d)
+{
+  d = _mm_add_epi16 (d, _mm_slli_si128 (d, 2));
+  d = _mm_add_epi16 (d, _mm_slli_si128 (d, 4));
+
+  return (_mm_add_epi16 (d, _mm_slli_si128 (d, 8)));
+}
+
+
+/*  Broadcast the last 16 bit lane to all lanes.  */
+
+CZMIL_TARGET_SSE42 CZMIL_INLINE __m128i czmil_last16_sse42 (__m128i d)
+{
+  return (_mm_shuffle_epi8 (d, _mm_set1_epi16 (0x0f0e)));
+}
+
+
+/*  Store the first 'count' (1 to 8) 16 bit lanes of d.  */
+
+CZMIL_TARGET_SSE42 CZMIL_INLINE void czmil_store16_sse42 (uint16_t *values, __m128i d, int32_t count)
+{
+  uint32_t               ui32value;
+
+
+  if (count >= 8)
+    {
+      _mm_storeu_si128 ((__m128i *) values, d);
+      return;
+    }
+
+
+  /*  Partial store, four, two, and then one value at a time.  */
+
+  if (count & 4)
+    {
+      _mm_storel_epi64 ((__m128i *) values, d);
+      d = _mm_srli_si128 (d, 8);
+      values += 4;
+    }
+
+  ui32value = _mm_cvtsi128_si32 (d);
+
+  if (count & 2)
+    {
+      memcpy (values, &ui32value, 4);
+      ui32value = _mm_extract_epi32 (d, 1);
+      values += 2;
+    }
+
+  if (count & 1) *values = (uint16_t) ui32value;
+}
+
+
+/*  Unpack four consecutive big endian (MSB first) 'delta_bits' wide fields (delta_bits <= 16) starting at bit position 'bpos'.
+    We load the 16 bytes starting at the byte holding the first bit, use a byte shuffle to pull the 4 bytes covering each field
+    into its own 32 bit lane (byte swapped), shift the field up to the top of the lane (multiplying by 2^shift since SSE doesn't
+    have a per lane variable shift), then shift it back down so it is right justified.  'step' holds 0, delta_bits,
+    2 * delta_bits, and 3 * delta_bits and 'rshift' holds 32 - delta_bits.  */
+
+CZMIL_TARGET_SSE42 CZMIL_INLINE __m128i czmil_unpack4_sse42 (const uint8_t *buffer, uint32_t bpos, __m128i step, __m128i rshift)
+{
+  __m128i                chunk, bit, byte, shift, mask, x;
+
+
+  chunk = _mm_loadu_si128 ((const __m128i *) &buffer[bpos >> 3]);
+
+  bit = _mm_add_epi32 (_mm_set1_epi32 (bpos & 7), step);
+  byte = _mm_srli_epi32 (bit, 3);
+  shift = _mm_and_si128 (bit, _mm_set1_epi32 (7));
+
+
+  /*  Replicate the byte index into all four bytes of the lane and add 3, 2, 1, 0 to get the (byte swapped) shuffle mask.  */
+
+  mask = _mm_shuffle_epi8 (byte, _mm_setr_epi8 (0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12));
+  mask = _mm_add_epi32 (mask, _mm_set1_epi32 (0x00010203));
+  x = _mm_shuffle_epi8 (chunk, mask);
+
+
+  /*  2^shift from a table lookup (the 0x80 bytes zero the upper three bytes of each lane).  */
+
+  shift = _mm_shuffle_epi8 (_mm_setr_epi8 (1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0),
+                            _mm_or_si128 (shift, _mm_set1_epi32 ((int32_t) 0x80808000)));
+  x = _mm_mullo_epi32 (x, shift);
+
+  return (_mm_srl_epi32 (x, rshift));
+}
+
+
+CZMIL_TARGET_SSE42 static void czmil_delta_decode_sse42 (CZMIL_BIT_READER *reader, int32_t count, int32_t delta_bits, int16_t offset,
+                                                         int16_t start, uint16_t *values)
+{
+  int32_t                k;
+  uint32_t               bpos, end;
+  __m128i                step, rshift, off, carry, d;
+
+
+  bpos = czmil_bit_reader_tell (reader);
+  end = bpos + count * delta_bits;
+
+  step = _mm_setr_epi32 (0, delta_bits, 2 * delta_bits, 3 * delta_bits);
+  rshift = _mm_cvtsi32_si128 (32 - delta_bits);
+  off = _mm_set1_epi16 (offset);
+  carry = _mm_set1_epi16 (start);
+
+  values[0] = start;
+
+  for (k = 0 ; k < count ; k += 8)
+    {
+      d = _mm_packus_epi32 (czmil_unpack4_sse42 (reader->buffer, bpos, step, rshift),
+                            czmil_unpack4_sse42 (reader->buffer, bpos + 4 * delta_bits, step, rshift));
+      d = czmil_prefix8_sse42 (_mm_sub_epi16 (d, off));
+
+      czmil_store16_sse42 (&values[k + 1], _mm_add_epi16 (d, carry), count - k);
+
+      carry = _mm_add_epi16 (carry, czmil_last16_sse42 (d));
+      bpos += 8 * delta_bits;
+    }
+
+
+  /*  Reposition the reader after the last delta.  */
+
+  czmil_bit_reader_init (reader, reader->buffer, reader->size, end);
+}
+
+
+CZMIL_TARGET_SSE42 static void czmil_prefix_sum_sse42 (int32_t count, const int16_t *delta, int16_t start, uint16_t *values)
+{
+  int32_t                k;
+  int16_t                tmp[8];
+  __m128i                carry, d;
+
+
+  carry = _mm_set1_epi16 (start);
+
+  values[0] = start;
+
+  for (k = 0 ; k < count ; k += 8)
+    {
+      if (count - k >= 8)
+        {
+          d = _mm_loadu_si128 ((const __m128i *) &delta[k]);
+        }
+      else
+        {
+          memset (tmp, 0, sizeof (tmp));
+          memcpy (tmp, &delta[k], (count - k) * sizeof (int16_t));
+          d = _mm_loadu_si128 ((const __m128i *) tmp);
+        }
+
+      d = czmil_prefix8_sse42 (d);
+
+      czmil_store16_sse42 (&values[k + 1], _mm_add_epi16 (d, carry), count - k);
+
+      carry = _mm_add_epi16 (carry, czmil_last16_sse42 (d));
+    }
+}
+
+
+/*  Same as czmil_unpack4_sse42 but does eight fields at a time (two sets of four, one in each 128 bit lane) and uses the AVX2
+    per lane variable shift instead of the multiply.  The result is returned as eight 16 bit values.  'mask' holds
+    2^delta_bits - 1 and 'bits' holds 32 - delta_bits in each 32 bit lane.  */
+
+CZMIL_TARGET_AVX2 CZMIL_INLINE __m128i czmil_unpack8_avx2 (const uint8_t *buffer, uint32_t bpos, int32_t delta_bits, __m256i step,
+                                                           __m256i bits, __m256i mask)
+{
+  uint32_t               bpos2;
+  __m256i                chunk, bit, byte, shuffle, x;
+
+
+  bpos2 = bpos + 4 * delta_bits;
+
+  chunk = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_loadu_si128 ((const __m128i *) &buffer[bpos >> 3])),
+                                   _mm_loadu_si128 ((const __m128i *) &buffer[bpos2 >> 3]), 1);
+
+  bit = _mm256_add_epi32 (_mm256_setr_epi32 (bpos & 7, bpos & 7, bpos & 7, bpos & 7, bpos2 & 7, bpos2 & 7, bpos2 & 7, bpos2 & 7), step);
+  byte = _mm256_srli_epi32 (bit, 3);
+
+  shuffle = _mm256_shuffle_epi8 (byte, _mm256_setr_epi8 (0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12,
+                                                         0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12));
+  shuffle = _mm256_add_epi32 (shuffle, _mm256_set1_epi32 (0x00010203));
+  x = _mm256_shuffle_epi8 (chunk, shuffle);
+
+
+  /*  The field starts (bit & 7) bits down from the top of the lane so we shift right by 32 - delta_bits - (bit & 7).  */
+
+  x = _mm256_srlv_epi32 (x, _mm256_sub_epi32 (bits, _mm256_and_si256 (bit, _mm256_set1_epi32 (7))));
+  x = _mm256_and_si256 (x, mask);
+
+
+  /*  Pack down to 16 bits and pull the two halves together.  */
+
+  x = _mm256_permute4x64_epi64 (_mm256_packus_epi32 (x, x), 0x08);
+
+  return (_mm256_castsi256_si128 (x));
+}
+
+
+CZMIL_TARGET_AVX2 static void czmil_delta_decode_avx2 (CZMIL_BIT_READER *reader, int32_t count, int32_t delta_bits, int16_t offset,
+                                                       int16_t start, uint16_t *values)
+{
+  int32_t                k;
+  uint32_t               bpos, end;
+  __m256i                step, bits, mask;
+  __m128i                off, carry, d;
+
+
+  bpos = czmil_bit_reader_tell (reader);
+  end = bpos + count * delta_bits;
+
+  step = _mm256_setr_epi32 (0, delta_bits, 2 * delta_bits, 3 * delta_bits, 0, delta_bits, 2 * delta_bits, 3 * delta_bits);
+  bits = _mm256_set1_epi32 (32 - delta_bits);
+  mask = _mm256_set1_epi32 ((1 << delta_bits) - 1);
+  off = _mm_set1_epi16 (offset);
+  carry = _mm_set1_epi16 (start);
+
+  values[0] = start;
+
+  for (k = 0 ; k < count ; k += 8)
+    {
+      d = czmil_unpack8_avx2 (reader->buffer, bpos, delta_bits, step, bits, mask);
+      d = czmil_prefix8_sse42 (_mm_sub_epi16 (d, off));
+
+      czmil_store16_sse42 (&values[k + 1], _mm_add_epi16 (d, carry), count - k);
+
+      carry = _mm_add_epi16 (carry, czmil_last16_sse42 (d));
+      bpos += 8 * delta_bits;
+    }
+
+
+  /*  Reposition the reader after the last delta.  */
+
+  czmil_bit_reader_init (reader, reader->buffer, reader->size, end);
+}
+
+
+
+/*  Horizontal signed minimum and maximum of eight 16 bit lanes.  */
+
+CZMIL_TARGET_SSE42 CZMIL_INLINE int16_t czmil_hmin16_sse42 (__m128i x)
+{
+  x = _mm_min_epi16 (x, _mm_srli_si128 (x, 8));
+  x = _mm_min_epi16 (x, _mm_srli_si128 (x, 4));
+  x = _mm_min_epi16 (x, _mm_srli_si128 (x, 2));
+
+  return ((int16_t) _mm_cvtsi128_si32 (x));
+}
+
+
+CZMIL_TARGET_SSE42 CZMIL_INLINE int16_t czmil_hmax16_sse42 (__m128i x)
+{
+  x = _mm_max_epi16 (x, _mm_srli_si128 (x, 8));
+  x = _mm_max_epi16 (x, _mm_srli_si128 (x, 4));
+  x = _mm_max_epi16 (x, _mm_srli_si128 (x, 2));
+
+  return ((int16_t) _mm_cvtsi128_si32 (x));
+}
+
+
+/*  All three difference types, with their minimums and maximums, eight samples at a time.  The packet is copied into a zero
+    padded local array so that we can load the samples one and two past the current one without running off the end of the
+    packet.  The lanes past the last valid first (63) and second (62) difference are masked out of the minimum and maximum
+    in the last set of eight.  */
+
+CZMIL_TARGET_SSE42 static void czmil_cwf_packet_analysis_sse42 (const uint16_t *packet, const uint16_t *central, int16_t *delta,
+                                                                int16_t *delta2, int16_t *delta3, int16_t *min_delta,
+                                                                int16_t *max_delta)
+{
+  int32_t                k;
+  uint16_t               v[80];
+  __m128i                a, b, c, d1, d2, d3, min1, max1, min2, max2, min3, max3, hi, lo;
+
+
+  memcpy (v, packet, 64 * sizeof (uint16_t));
+  memset (&v[64], 0, 16 * sizeof (uint16_t));
+
+  min1 = min2 = min3 = _mm_set1_epi16 (32767);
+  max1 = max2 = max3 = _mm_set1_epi16 (-32768);
+
+  for (k = 0 ; k < 64 ; k += 8)
+    {
+      a = _mm_loadu_si128 ((const __m128i *) &v[k]);
+      b = _mm_loadu_si128 ((const __m128i *) &v[k + 1]);
+      c = _mm_loadu_si128 ((const __m128i *) &v[k + 2]);
+
+      d1 = _mm_sub_epi16 (b, a);
+      d2 = _mm_sub_epi16 (_mm_sub_epi16 (c, b), d1);
+
+      _mm_storeu_si128 ((__m128i *) &delta[k], d1);
+      _mm_storeu_si128 ((__m128i *) &delta2[k], d2);
+
+
+      /*  Mask out the invalid lanes in the last set.  */
+
+      if (k == 56)
+        {
+          hi = _mm_setr_epi16 (-32768, -32768, -32768, -32768, -32768, -32768, -32768, 32767);
+          lo = _mm_setr_epi16 (32767, 32767, 32767, 32767, 32767, 32767, 32767, -32768);
+          min1 = _mm_min_epi16 (min1, _mm_max_epi16 (d1, hi));
+          max1 = _mm_max_epi16 (max1, _mm_min_epi16 (d1, lo));
+
+          hi = _mm_setr_epi16 (-32768, -32768, -32768, -32768, -32768, -32768, 32767, 32767);
+          lo = _mm_setr_epi16 (32767, 32767, 32767, 32767, 32767, 32767, -32768, -32768);
+          min2 = _mm_min_epi16 (min2, _mm_max_epi16 (d2, hi));
+          max2 = _mm_max_epi16 (max2, _mm_min_epi16 (d2, lo));
+        }
+      else
+        {
+          min1 = _mm_min_epi16 (min1, d1);
+          max1 = _mm_max_epi16 (max1, d1);
+          min2 = _mm_min_epi16 (min2, d2);
+          max2 = _mm_max_epi16 (max2, d2);
+        }
+
+      if (central != NULL)
+        {
+          d3 = _mm_sub_epi16 (a, _mm_loadu_si128 ((const __m128i *) &central[k]));
+          _mm_storeu_si128 ((__m128i *) &delta3[k], d3);
+
+          min3 = _mm_min_epi16 (min3, d3);
+          max3 = _mm_max_epi16 (max3, d3);
+        }
+    }
+
+  min_delta[1] = czmil_hmin16_sse42 (min1);
+  max_delta[1] = czmil_hmax16_sse42 (max1);
+  min_delta[2] = czmil_hmin16_sse42 (min2);
+  max_delta[2] = czmil_hmax16_sse42 (max2);
+  min_delta[3] = czmil_hmin16_sse42 (min3);
+  max_delta[3] = czmil_hmax16_sse42 (max3);
+}
+
+
+/*  Same as czmil_cwf_packet_analysis_sse42 but sixteen samples at a time.  */
+
+CZMIL_TARGET_AVX2 static void czmil_cwf_packet_analysis_avx2 (const uint16_t *packet, const uint16_t *central, int16_t *delta,
+                                                              int16_t *delta2, int16_t *delta3, int16_t *min_delta,
+                                                              int16_t *max_delta)
+{
+  int32_t                k;
+  uint16_t               v[80];
+  __m256i                a, b, c, d1, d2, d3, min1, max1, min2, max2, min3, max3, hi, lo;
+
+
+  memcpy (v, packet, 64 * sizeof (uint16_t));
+  memset (&v[64], 0, 16 * sizeof (uint16_t));
+
+  min1 = min2 = min3 = _mm256_set1_epi16 (32767);
+  max1 = max2 = max3 = _mm256_set1_epi16 (-32768);
+
+  for (k = 0 ; k < 64 ; k += 16)
+    {
+      a = _mm256_loadu_si256 ((const __m256i *) &v[k]);
+      b = _mm256_loadu_si256 ((const __m256i *) &v[k + 1]);
+      c = _mm256_loadu_si256 ((const __m256i *) &v[k + 2]);
+
+      d1 = _mm256_sub_epi16 (b, a);
+      d2 = _mm256_sub_epi16 (_mm256_sub_epi16 (c, b), d1);
+
+      _mm256_storeu_si256 ((__m256i *) &delta[k], d1);
+      _mm256_storeu_si256 ((__m256i *) &delta2[k], d2);
+
+
+      /*  Mask out the invalid lanes in the last set.  */
+
+      if (k == 48)
+        {
+          hi = _mm256_setr_epi16 (-32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768,
+                                  -32768, -32768, -32768, -32768, -32768, -32768, -32768, 32767);
+          lo = _mm256_setr_epi16 (32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+                                  32767, 32767, 32767, 32767, 32767, 32767, 32767, -32768);
+          min1 = _mm256_min_epi16 (min1, _mm256_max_epi16 (d1, hi));
+          max1 = _mm256_max_epi16 (max1, _mm256_min_epi16 (d1, lo));
+
+          hi = _mm256_setr_epi16 (-32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768,
+                                  -32768, -32768, -32768, -32768, -32768, -32768, 32767, 32767);
+          lo = _mm256_setr_epi16 (32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+                                  32767, 32767, 32767, 32767, 32767, 32767, -32768, -32768);
+          min2 = _mm256_min_epi16 (min2, _mm256_max_epi16 (d2, hi));
+          max2 = _mm256_max_epi16 (max2, _mm256_min_epi16 (d2, lo));
+        }
+      else
+        {
+          min1 = _mm256_min_epi16 (min1, d1);
+          max1 = _mm256_max_epi16 (max1, d1);
+          min2 = _mm256_min_epi16 (min2, d2);
+          max2 = _mm256_max_epi16 (max2, d2);
+        }
+
+      if (central != NULL)
+        {
+          d3 = _mm256_sub_epi16 (a, _mm256_loadu_si256 ((const __m256i *) &central[k]));
+          _mm256_storeu_si256 ((__m256i *) &delta3[k], d3);
+
+          min3 = _mm256_min_epi16 (min3, d3);
+          max3 = _mm256_max_epi16 (max3, d3);
+        }
+    }
+
+  min_delta[1] = czmil_hmin16_sse42 (_mm_min_epi16 (_mm256_castsi256_si128 (min1), _mm256_extracti128_si256 (min1, 1)));
+  max_delta[1] = czmil_hmax16_sse42 (_mm_max_epi16 (_mm256_castsi256_si128 (max1), _mm256_extracti128_si256 (max1, 1)));
+  min_delta[2] = czmil_hmin16_sse42 (_mm_min_epi16 (_mm256_castsi256_si128 (min2), _mm256_extracti128_si256 (min2, 1)));
+  max_delta[2] = czmil_hmax16_sse42 (_mm_max_epi16 (_mm256_castsi256_si128 (max2), _mm256_extracti128_si256 (max2, 1)));
+  min_delta[3] = czmil_hmin16_sse42 (_mm_min_epi16 (_mm256_castsi256_si128 (min3), _mm256_extracti128_si256 (min3, 1)));
+  max_delta[3] = czmil_hmax16_sse42 (_mm_max_epi16 (_mm256_castsi256_si128 (max3), _mm256_extracti128_si256 (max3, 1)));
+}
+
+#endif
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_delta_decode
+
+ - Purpose:     Reads 'count' fixed width deltas from a CZMIL_BIT_READER, removes the offset
+                from each of them, and integrates them starting at 'start'.  This uses the
+                AVX2 or SSE4.2 kernel if the CPU supports it and the packet is far enough from
+                the end of the buffer that the 16 byte loads can't run off of it.  Otherwise
+                it falls back to czmil_delta_decode_scalar.  The results are identical.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - reader          =   pointer to the CZMIL_BIT_READER
+                - count           =   number of deltas to read
+                - delta_bits      =   number of bits used to store each delta (0 to 16)
+                - offset          =   offset to be removed from each delta
+                - start           =   start value
+                - values          =   count + 1 output values
+
+ - Returns:
+                - void
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_delta_decode (CZMIL_BIT_READER *reader, int32_t count, int32_t delta_bits, int16_t offset, int16_t start,
+                                      uint16_t *values)
+{
+#ifdef CZMIL_X86_SIMD
+
+  /*  The kernels work eight deltas at a time and the last 16 byte load starts no later than the byte holding the last bit.  */
+
+  if (delta_bits <= 16 && ((czmil_bit_reader_tell (reader) + ((count + 7) & ~7) * delta_bits) >> 3) + 16 <= reader->size)
+    {
+      switch (czmil_simd_level ())
+        {
+        case CZMIL_SIMD_AVX2:
+          czmil_delta_decode_avx2 (reader, count, delta_bits, offset, start, values);
+          return;
+
+        case CZMIL_SIMD_SSE42:
+          czmil_delta_decode_sse42 (reader, count, delta_bits, offset, start, values);
+          return;
+        }
+    }
+
+#endif
+
+  czmil_delta_decode_scalar (reader, count, delta_bits, offset, start, values);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_prefix_sum
+
+ - Purpose:     Integrates 'count' already unpacked deltas starting at 'start' using the SSE4.2
+                kernel if the CPU supports it, otherwise czmil_prefix_sum_scalar.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - count           =   number of deltas
+                - delta           =   deltas
+                - start           =   start value
+                - values          =   count + 1 output values
+
+ - Returns:
+                - void
+
+ - Caveats:     This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_prefix_sum (int32_t count, const int16_t *delta, int16_t start, uint16_t *values)
+{
+#ifdef CZMIL_X86_SIMD
+
+  if (czmil_simd_level () != CZMIL_SIMD_NONE)
+    {
+      czmil_prefix_sum_sse42 (count, delta, start, values);
+      return;
+    }
+
+#endif
+
+  czmil_prefix_sum_scalar (count, delta, start, values);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_cwf_packet_analysis
+
+ - Purpose:     Computes the first differences, second differences, and (optionally) the
+                differences from the shallow central channel of a 64 sample CWF packet along
+                with the minimum and maximum value of each.  This uses the AVX2 or SSE4.2
+                kernel if the CPU supports it, otherwise czmil_cwf_packet_analysis_scalar.  The
+                results are identical.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:   See czmil_cwf_packet_analysis_scalar
+
+ - Returns:
+                - void
+
+ - Caveats:     The delta, delta2, and delta3 arrays must have room for 64 values.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_cwf_packet_analysis (const uint16_t *packet, const uint16_t *central, int16_t *delta, int16_t *delta2,
+                                             int16_t *delta3, int16_t *min_delta, int16_t *max_delta)
+{
+#ifdef CZMIL_X86_SIMD
+
+  switch (czmil_simd_level ())
+    {
+    case CZMIL_SIMD_AVX2:
+      czmil_cwf_packet_analysis_avx2 (packet, central, delta, delta2, delta3, min_delta, max_delta);
+      return;
+
+    case CZMIL_SIMD_SSE42:
+      czmil_cwf_packet_analysis_sse42 (packet, central, delta, delta2, delta3, min_delta, max_delta);
+      return;
+    }
+
+#endif
+
+  czmil_cwf_packet_analysis_scalar (packet, central, delta, delta2, delta3, min_delta, max_delta);
+}
+
+
+
+/*******************************************************************************************/
+/*!
+
+ - Function:    czmil_cwf_channel_difference_range
+
+ - Purpose:     Computes the minimum and maximum difference between a 64 sample CWF packet
+                and a reference packet from another shallow channel.  Used by
+                czmil_compress_cwf_record to pick the reference for a
+                CZMIL_CROSS_CHANNEL_DIFFERENCE packet.
+
+ - Author:      PFM Software
+
+ - Date:        10/16/26
+
+ - Arguments:
+                - packet          =   64 waveform samples
+                - reference       =   64 samples of the reference packet
+                - min_delta       =   returned minimum difference
+                - max_delta       =   returned maximum difference
+
+ - Returns:
+                - void
+
+ - Caveats:     The loop is simple enough for the compiler to vectorize so there are no
+                hand written SIMD versions of this one.
+
+                This function is static, it is only used internal to the API and is not
+                callable from an external program.
+
+*********************************************************************************************/
+
+CZMIL_INLINE void czmil_cwf_channel_difference_range (const uint16_t *packet, const uint16_t *reference, int16_t *min_delta,
+                                                      int16_t *max_delta)
+{
+  int32_t                k;
+  int16_t                diff, min_diff = 32767, max_diff = -32768;
+
+
+  for (k = 0 ; k < 64 ; k++)
+    {
+      diff = packet[k] - reference[k];
+      min_diff = MIN (diff, min_diff);
+      max_diff = MAX (diff, max_diff);
+    }
+
+  *min_delta = min_diff;
+  *max_delta = max_diff;
+}
+
+
+
 /*******************************************************************************************/
 /*!
 
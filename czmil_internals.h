@@ -98,6 +98,43 @@ extern "C" {
 #define       CZMIL_FIRST_DIFFERENCE              1
 #define       CZMIL_SECOND_DIFFERENCE             2
 #define       CZMIL_SHALLOW_CENTRAL_DIFFERENCE    3
+#define       CZMIL_RICE_DIFFERENCE               4           /*!<  Adaptive Rice coded first differences.  Version 3.19 and later.  */
+#define       CZMIL_CROSS_CHANNEL_DIFFERENCE      5           /*!<  Differences from a packet of another shallow channel.  Version 3.20 and later.  */
+
+
+  /*  Returns non-zero if the file version major.minor is at least req_major.req_minor.  Used for format changes that
+      were made in minor versions.  */
+
+#define       CZMIL_VERSION_AT_LEAST(major, minor, req_major, req_minor) ((major) > (req_major) || ((major) == (req_major) && (minor) >= (req_minor)))
+
+
+  /*  Zigzag mapping of signed 16 bit differences to unsigned values (0, -1, 1, -2, 2... becomes 0, 1, 2, 3, 4...) and
+      back.  Used by the CZMIL_RICE_DIFFERENCE compression type.  */
+
+#define       CZMIL_ZIGZAG(d)                     ((uint32_t) (uint16_t) (((uint32_t) (d) << 1) ^ (uint32_t) ((int32_t) (d) >> 15)))
+#define       CZMIL_UNZIGZAG(z)                   ((int16_t) (((z) >> 1) ^ (0 - ((z) & 1))))
+
+
+  /*  SIMD instruction set levels used to pick the waveform decode kernels at run time (see czmil_simd_level in
+      czmil_functions.h).  The SIMD kernels are only built for x86 with GCC compatible compilers.  Define CZMIL_NO_SIMD
+      to force the scalar code everywhere.  */
+
+#define       CZMIL_SIMD_NONE                     0
+#define       CZMIL_SIMD_SSE42                    1
+#define       CZMIL_SIMD_AVX2                     2
+
+#if (defined __GNUC__) && ((defined __x86_64__) || (defined __i386__)) && (!defined CZMIL_NO_SIMD)
+#define       CZMIL_X86_SIMD
+#endif
+
+
+  /*  Storage class for the per-thread error state (see czmil_error in czmil.c).  */
+
+#if (defined _WIN32) && (defined _MSC_VER)
+#define       CZMIL_THREAD_LOCAL                  __declspec(thread)
+#else
+#define       CZMIL_THREAD_LOCAL                  __thread
+#endif
 
 
 
@@ -145,6 +182,29 @@ extern "C" {
                                                         which is a good bit more than the time bits allows so this should never
                                                         max out).  */
 #define CWF_VALIDITY_REASON_BITS  4               /*!<  Number of bits used for validity reason.  */
+#define CWF_RICE_ESCAPE           12              /*!<  A CZMIL_RICE_DIFFERENCE unary prefix of this many 1 bits means that the
+                                                        value follows as a CWF_RICE_RAW_BITS raw value.  */
+#define CWF_RICE_RAW_BITS         11              /*!<  Number of bits used to store an escaped CZMIL_RICE_DIFFERENCE value.  The
+                                                        zigzag encoded difference of two 10 bit values always fits in 11 bits.  */
+#define CWF_RICE_WINDOW           8               /*!<  The CZMIL_RICE_DIFFERENCE running sum and count are halved when the count
+                                                        gets to this so that the Rice parameter follows the recent values.  */
+#define CWF_REF_CHANNEL_BITS      3               /*!<  Number of bits used to store the reference shallow channel of a
+                                                        CZMIL_CROSS_CHANNEL_DIFFERENCE packet.  */
+#define CWF_RAW_DATA_BYTES        (9 * CZMIL_MAX_PACKETS * (8 + 8 + 64 * 10) / 8)
+                                                /*!<  Number of bytes of the czmil_write_cwf_record data block used by each
+                                                        record (the packet numbers, ranges, and 10 bit samples of
+                                                        CZMIL_MAX_PACKETS packets for each of the 9 channels).  */
+#define CWF_WRITE_BATCH           1024            /*!<  Number of records that czmil_write_cwf_record_array compresses in parallel
+                                                        before adding them to the file.  */
+#define CWF_T0_MAX_KEY_INTERVAL   256             /*!<  Largest allowed T0 key record interval (see czmil_set_cwf_t0_key_interval).
+                                                        A random read of a T0 predicted record may have to unpack the T0 of
+                                                        up to this many earlier records.  */
+#define CWF_EXTENDED_MAJOR_VERSION 4              /*!<  Major version written to the [VERSION] of a CWF file that uses a record
+                                                        format that older libraries can't read (see czmil_set_cwf_version).  */
+#define CWF_EXTENDED_LIBRARY      "CZMIL extended library"
+                                                /*!<  Replaces "CZMIL library" in the [VERSION] of those files.  Libraries
+                                                        older than 3.37 look for "CZMIL library" at the start of the file and
+                                                        refuse to open it (CZMIL_NOT_CZMIL_FILE_ERROR) if it isn't there.  */
 
 
   /*  These are default bit/byte field sizes and scale factors used for CPF point cloud data compression/decompression.  */
@@ -331,6 +391,95 @@ extern "C" {
   } CZMIL_CIF_Data;
 
 
+  /*!  Record number or file address and the position in the caller's list of a record being read by one of the
+       czmil_read_c?f_records_by_index functions.  These are sorted by key with qsort (see czmil_index_sort_compare).  */
+
+  typedef struct
+  {
+    int64_t           key;                        /*!<  Record number or byte address in the file.  */
+    int32_t           index;                      /*!<  Index of the record in the caller's list.  */
+  } CZMIL_INDEX_SORT;
+
+
+  /*!  One block of CIF_INDEX_BLOCK_RECORDS records of a resident CIF index (see czmil_load_cif_index).  CWF and CPF records are
+       almost always stored back to back so we only keep the address of the first record in the block and add up the buffer
+       sizes to get to the others.  If they aren't back to back the addresses of all of the records in the block are kept in
+       the exception table.  */
+
+  typedef struct
+  {
+    int64_t           cwf_address;                /*!<  Byte address of the first CWF record in the block.  */
+    int64_t           cpf_address;                /*!<  Byte address of the first CPF record in the block.  */
+    int32_t           cwf_exception;              /*!<  Index of the block's CWF addresses in the exception table or -1.  */
+    int32_t           cpf_exception;              /*!<  Index of the block's CPF addresses in the exception table or -1.  */
+  } CZMIL_CIF_INDEX_BLOCK;
+
+
+  /*!  State for scanning the record size chain of a CWF or CPF file when regenerating its CIF file (see czmil_scan_cif_sizes).
+       The file is read in large, aligned blocks and the records are found by walking the buffer sizes in memory.  */
+
+  typedef struct
+  {
+    FILE              *fp;                        /*!<  CWF or CPF file pointer.  */
+    int64_t           file_size;                  /*!<  Size of the file in bytes.  */
+    int64_t           pos;                        /*!<  Byte address of the next record.  */
+    int64_t           window_start;               /*!<  Byte address of the first byte in window.  */
+    int32_t           window_length;              /*!<  Number of bytes in window.  */
+    uint8_t           *window;                    /*!<  CIF_SCAN_BLOCK_SIZE bytes read from the file.  */
+    int16_t           buffer_size_bytes;          /*!<  Size of the buffer size at the start of each record.  */
+    int16_t           buffer_size_bits;           /*!<  Number of bits used for the buffer size in the CIF file.  */
+    int64_t           *address;                   /*!<  Returned record addresses (CIF_SCAN_RECORDS entries).  */
+    uint16_t          *size;                      /*!<  Returned record buffer sizes (CIF_SCAN_RECORDS entries).  */
+    int32_t           recnum;                     /*!<  Record number of the next record.  */
+    int32_t           status;                     /*!<  0, or the record number (plus one) of the first bad record.  */
+    int32_t           system_error;               /*!<  errno from the failed read, if any.  */
+  } CZMIL_CIF_SCAN;
+
+
+  /*!  Sequential bit reader cursor.  This is used by the record decoders (czmil_uncompress_cwf_record, czmil_read_cpf_record,
+       etc.) to pull consecutive fields out of a bit-packed buffer without recomputing the start and end bytes for every field
+       the way czmil_bit_unpack does.  See czmil_bit_reader_init in czmil_functions.h.  */
+
+  typedef struct
+  {
+    const uint8_t     *buffer;                    /*!<  Bit-packed buffer we're reading from.  */
+    uint32_t          size;                       /*!<  Number of valid bytes in the buffer.  */
+    uint32_t          pos;                        /*!<  Next byte in the buffer to be loaded into the accumulator.  */
+    uint64_t          acc;                        /*!<  Bit accumulator.  The next bit to be read is always the high order bit.  */
+    int32_t           bits;                       /*!<  Number of valid bits in the accumulator.  */
+  } CZMIL_BIT_READER;
+
+
+  /*!  Sequential bit writer cursor.  This is the packing counterpart of CZMIL_BIT_READER.  It is used by the record encoders
+       (czmil_compress_cwf_record, czmil_write_cpf_record, etc.) to append consecutive fields to a bit-packed buffer a 32 bit
+       word at a time instead of doing a read-modify-write of every byte touched by every field the way czmil_bit_pack does.
+       See czmil_bit_writer_init in czmil_functions.h.  */
+
+  typedef struct
+  {
+    uint8_t           *buffer;                    /*!<  Bit-packed buffer we're writing to.  */
+    uint32_t          pos;                        /*!<  Next byte in the buffer to be stored from the accumulator.  */
+    uint64_t          acc;                        /*!<  Bit accumulator.  The oldest bit not yet stored is always the high order bit.  */
+    int32_t           bits;                       /*!<  Number of bits in the accumulator that haven't been stored yet.  */
+  } CZMIL_BIT_WRITER;
+
+
+  /*!  One entry in the pool of create/open I/O buffers (see czmil_get_io_buffer and czmil_release_io_buffer).  */
+
+  typedef struct
+  {
+    uint8_t           *buffer;                    /*!<  The buffer.  */
+    int64_t           size;                       /*!<  Allocated size of the buffer in bytes.  */
+    uint8_t           in_use;                     /*!<  Set if a file handle is using the buffer.  */
+  } CZMIL_IO_BUFFER;
+
+
+  /*!  Width specialized unpack kernel.  Unpacks 'count' consecutive fields of a fixed width from a CZMIL_BIT_READER.  There is
+       one of these for each width from 0 to 32 (see czmil_unpack_select in czmil_functions.h).  */
+
+  typedef void (*CZMIL_UNPACK_FUNC) (CZMIL_BIT_READER *reader, int32_t count, uint32_t *values);
+
+
   /*!  This is the structure we use to keep track of important formatting data for an open CZMIL CIF file.  */
 
   typedef struct
@@ -354,6 +503,23 @@ extern "C" {
     uint32_t          io_buffer_address;          /*!<  Location within the I/O buffer at which we will place our next compressed
                                                         block of index data.  This is only used during creation of the CIF file.  */
     uint8_t           *io_buffer;                 /*!<  The actual I/O buffer that will be allocated on creation/open and freed on close.  */
+    uint8_t           *map;                       /*!<  Memory mapped CIF file (CZMIL_READONLY_MMAP mode only, otherwise NULL).  */
+    int64_t           map_size;                   /*!<  Size of the memory mapped CIF file in bytes.  */
+
+
+    /*  The following is the CIF index that we keep in memory when the file is opened CZMIL_READONLY (see czmil_load_cif_index
+        and czmil_cif_index_lookup).  These are NULL if the index isn't resident.  */
+
+    CZMIL_CIF_INDEX_BLOCK *block;                 /*!<  Block base addresses (one per CIF_INDEX_BLOCK_RECORDS records).  */
+    uint16_t          *cwf_buffer_size;           /*!<  CWF record buffer sizes.  */
+    uint16_t          *cpf_buffer_size;           /*!<  CPF record buffer sizes.  */
+    int64_t           *exception;                 /*!<  Addresses of the records in blocks whose records aren't back to back.  */
+    int64_t           index_size;                 /*!<  Memory used by the resident index in bytes.  */
+    uint8_t           cursor;                     /*!<  Set if this is a CWF or CPF cursor's copy of another CIF handle (see
+                                                        czmil_open_cif_cursor).  The file pointer, mapping, and resident
+                                                        index belong to the other handle.  */
+    int32_t           users;                      /*!<  Number of open CWF and CPF handles that are using this CIF handle (see
+                                                        czmil_release_cif_handle).  */
   } INTERNAL_CZMIL_CIF_STRUCT;
 
 
@@ -372,9 +538,10 @@ extern "C" {
     int64_t           pos;                        /*!<  Position of the CWF file pointer after last I/O operation.  */
     INTERNAL_CZMIL_CIF_STRUCT cif;                /*!<  This structure is used when creating the CIF file during creation of the CWF and CPF files.  */
     int32_t           cif_hnd;                    /*!<  Handle for the associated CIF file.  */
-    char              app_tags[CZMIL_CWF_HEADER_SIZE];
-                                                  /*!<  Place to hold application defined header fields when we read the header so that we can
-                                                        write it back out if we modify any header fields.  */
+    char              *app_tags;                  /*!<  Place to hold application defined header fields when we read the header so that we can
+                                                        write it back out if we modify any header fields.  Only allocated if the file
+                                                        has application defined fields (see czmil_add_app_tags).  */
+    int32_t           app_tags_size;              /*!<  Allocated size of the application defined header fields buffer.  */
     int32_t           app_tags_pos;               /*!<  Current position within the application defined header fields buffer.  */
 
 
@@ -399,6 +566,9 @@ extern "C" {
     float             range_scale;                /*!<  Scale value for ranges.  */
     uint16_t          shot_id_bits;               /*!<  Number of bits used to store the shot ID.  */
     uint16_t          validity_reason_bits;       /*!<  Number of bits used to store validity reason.  */
+    uint16_t          t0_key_interval;            /*!<  Every t0_key_interval'th record is a T0 key record.  The T0 of the other
+                                                        records may be stored as differences from the previous record's T0.
+                                                        Zero if T0 prediction isn't used (version 3.21 and later).  */
 
 
     /*  The following information is computed from the information read from the CWF file ASCII header but is not placed in the
@@ -419,6 +589,8 @@ extern "C" {
     uint16_t          type_1_header_bits;         /*!<  Bits used for the CWF type 1 compressed CWF packet header.  */
     uint16_t          type_2_header_bits;         /*!<  Bits used for the CWF type 2 compressed CWF packet header.  */
     uint16_t          type_3_header_bits;         /*!<  Bits used for the CWF type 3 compressed CWF packet header.  */
+    uint16_t          type_4_header_bits;         /*!<  Bits used for the CWF type 4 compressed CWF packet header.  */
+    uint16_t          type_5_header_bits;         /*!<  Bits used for the CWF type 5 compressed CWF packet header.  */
     uint32_t          time_max;                   /*!<  Maximum time offset (usecs) from start timestamp.  Computed from time_bits.  */
     uint16_t          num_packets_bits;           /*!<  Number of bits used to store the number of packets per channel.  Computed from
                                                         czmil_max_packets.  */
@@ -428,6 +600,15 @@ extern "C" {
     uint32_t          validity_reason_max;        /*!<  Maximum validity reason value.  Computed from validity_reason_bits.  */
     uint16_t          major_version;              /*!<  Major version number (broken out of the version string).  */
     uint16_t          minor_version;              /*!<  Minor version number (broken out of the version string).  */
+    CZMIL_UNPACK_FUNC packet_number_unpack;       /*!<  Unpack kernel for packet_number_bits.  Selected on create/open.  */
+    CZMIL_UNPACK_FUNC range_unpack;               /*!<  Unpack kernel for range_bits.  Selected on create/open.  */
+    CZMIL_UNPACK_FUNC validity_reason_unpack;     /*!<  Unpack kernel for validity_reason_bits.  Selected on create/open.  */
+    uint8_t           rice_allowed;               /*!<  Set if the file may contain CZMIL_RICE_DIFFERENCE packets ([RICE PACKETS] in
+                                                        the header or a 3.19 to 3.36 file).  */
+    uint8_t           cross_channel_allowed;      /*!<  Set if the file may contain CZMIL_CROSS_CHANNEL_DIFFERENCE packets ([CROSS
+                                                        CHANNEL PACKETS] in the header or a 3.20 to 3.36 file).  */
+    uint16_t          t0_prev[64];                /*!<  T0 waveform of record t0_prev_recnum.  Used to predict the next T0.  */
+    int32_t           t0_prev_recnum;             /*!<  Record number of the T0 in t0_prev (-1 if none).  */
 
 
     /*  The following is related to the CWF I/O buffer.  These are used for an internal buffer on creation or a setvbuf buffer
@@ -439,6 +620,16 @@ extern "C" {
     uint8_t           *io_buffer;                 /*!<  The actual I/O buffer that will be allocated on creation and freed on close.  */
     int64_t           create_file_pos;            /*!<  This is the apparent file position that we will use to create the CIF file as
                                                         we create the CWF file.  */
+    uint8_t           *map;                       /*!<  Memory mapped CWF file (CZMIL_READONLY_MMAP mode only, otherwise NULL).  */
+    int64_t           map_size;                   /*!<  Size of the memory mapped CWF file in bytes.  */
+
+
+    /*  The following is used for cursors (see czmil_open_cwf_cursor).  A cursor is a copy of another handle's structure that
+        shares its file pointer, mapping, and header but reads with pread so that it never moves the shared file pointer.  */
+
+    uint8_t           cursor;                     /*!<  Set if this handle is a cursor.  */
+    int32_t           parent;                     /*!<  Handle that this cursor was opened on.  */
+    int32_t           cursors;                    /*!<  Number of cursors open on this handle.  */
   } INTERNAL_CZMIL_CWF_STRUCT;
 
 
@@ -456,9 +647,10 @@ extern "C" {
     int32_t           mode;                       /*!<  File open mode (CZMIL_UPDATE, CZMIL_READONLY, or CZMIL_READONLY_SEQUENTIAL).  */
     int64_t           pos;                        /*!<  Position of the CPF file pointer after last I/O operation.  */
     int32_t           cif_hnd;                    /*!<  Handle for the associated CIF file.  */
-    char              app_tags[CZMIL_CPF_HEADER_SIZE];
-                                                  /*!<  Place to hold application defined header fields when we read the header so that we can
-                                                        write it back out if we modify any header fields.  */
+    char              *app_tags;                  /*!<  Place to hold application defined header fields when we read the header so that we can
+                                                        write it back out if we modify any header fields.  Only allocated if the file
+                                                        has application defined fields (see czmil_add_app_tags).  */
+    int32_t           app_tags_size;              /*!<  Allocated size of the application defined header fields buffer.  */
     int32_t           app_tags_pos;               /*!<  Current position within the application defined header fields buffer.  */
 
 
@@ -529,6 +721,7 @@ extern "C" {
     uint32_t          time_max;                   /*!<  Maximum time offset (usecs) from start timestamp.  Computed from time_bits.  */
     uint32_t          return_status_max;          /*!<  Maximum status value.  Computed from return_status_bits.  */
     uint16_t          return_bits;                /*!<  Number of bits used to store the number of returns per channel.  */
+    CZMIL_UNPACK_FUNC return_unpack;              /*!<  Unpack kernel for return_bits.  Selected on create/open.  */
     uint16_t          interest_point_bits;        /*!<  Number of bits used to store the interest point
                                                         (based on CZMIL_MAX_PACKETS * 64 samples/packet).  */
     uint32_t          interest_point_max;         /*!<  Maximum size of scaled interest point value (2^interest_point_bits).  */
@@ -548,8 +741,7 @@ extern "C" {
     /*  The following is related to the CPF I/O buffer.  These are used for an internal buffer on creation or a setvbuf buffer
         when opening as CZMIL_READONLY_SEQUENTIAL.  */
 
-    uint8_t           buffer[sizeof (CZMIL_CPF_Data)];
-                                                  /*!<  This is the single record buffer.  This is used when updating a CPF record.  In most cases
+    uint8_t           *buffer;                    /*!<  This is the single record buffer.  This is used when updating a CPF record.  In most cases
                                                         an application will read a CPF record, modify the modifiable parts of the record (status,
                                                         classification, datum offset, etc.) then write the record.  Since storing floating point
                                                         numbers like the latitude requires a little lost precision every time we do it we don't
@@ -558,8 +750,9 @@ extern "C" {
                                                         space between the czmil_read_cpf_record and czmil_write_cpf_record functions and keep
                                                         track of the last record number read so we don't, in many cases, have to read the buffer.
                                                         The actual data will never be sizeof (CZMIL_CPF_Data) in size since we are unpacking it
-                                                        but this way we don't have to worry about blowing this up.  Also, we don't allocate the
-                                                        memory because memory allocation invokes a system wide mutex.  */
+                                                        but this way we don't have to worry about blowing this up.  It's allocated once when
+                                                        the file is opened or created (not for every record since memory allocation invokes a
+                                                        system wide mutex) and freed when the file is closed.  */
     int32_t           last_record_read;           /*!<  Last record number read in czmil_read_cpf_record.  Used in czmil_write_cpf_record.  */
     uint32_t          io_buffer_size;             /*!<  CPF I/O buffer size.  */
     uint32_t          io_buffer_address;          /*!<  Location within the I/O buffer at which we will place our next compressed
@@ -567,6 +760,16 @@ extern "C" {
     uint8_t           *io_buffer;                 /*!<  The actual I/O buffer that will be allocated on creation/open and freed on close.  */
     int64_t           create_file_pos;            /*!<  This is the apparent file position that we will use to update the CIF file as
                                                         we create the CPF file.  */
+    uint8_t           *map;                       /*!<  Memory mapped CPF file (CZMIL_READONLY_MMAP mode only, otherwise NULL).  */
+    int64_t           map_size;                   /*!<  Size of the memory mapped CPF file in bytes.  */
+
+
+    /*  The following is used for cursors (see czmil_open_cpf_cursor).  A cursor is a copy of another handle's structure that
+        shares its file pointer, mapping, and header but reads with pread so that it never moves the shared file pointer.  */
+
+    uint8_t           cursor;                     /*!<  Set if this handle is a cursor.  */
+    int32_t           parent;                     /*!<  Handle that this cursor was opened on.  */
+    int32_t           cursors;                    /*!<  Number of cursors open on this handle.  */
   } INTERNAL_CZMIL_CPF_STRUCT;
 
 
@@ -583,9 +786,10 @@ extern "C" {
     uint8_t           write;                      /*!<  Set if the last action to the CSF file was a write.  */
     int32_t           mode;                       /*!<  File open mode (CZMIL_UPDATE, CZMIL_READONLY, or CZMIL_READONLY_SEQUENTIAL).  */
     int64_t           pos;                        /*!<  Position of the CSF file pointer after last I/O operation.  */
-    char              app_tags[CZMIL_CSF_HEADER_SIZE];  /*!<  Place to hold application defined header fields when we read the
-                                                              header so that we can write it back out if we modify any header
-                                                              fields.  */
+    char              *app_tags;                  /*!<  Place to hold application defined header fields when we read the header so that we can
+                                                        write it back out if we modify any header fields.  Only allocated if the file
+                                                        has application defined fields (see czmil_add_app_tags).  */
+    int32_t           app_tags_size;              /*!<  Allocated size of the application defined header fields buffer.  */
     int32_t           app_tags_pos;               /*!<  Current position within the application defined header fields buffer.  */
 
 
@@ -633,15 +837,15 @@ extern "C" {
     /*  The following is related to the CSF I/O buffer.  These are used for an internal buffer on creation or a setvbuf buffer
         when opening as CZMIL_READONLY_SEQUENTIAL.  */
 
-    uint8_t           buffer[sizeof (CZMIL_CSF_Data)];
-                                                  /*!<  This is the single record buffer.  This is used when updating a CSF record.
-                                                        The actual data will never be sizeof (CZMIL_CSF_Data) in size since we are packing it
-                                                        but this way we don't have to worry about blowing this up.  Also, we don't allocate the
-                                                        memory because memory allocation invokes a system wide mutex.  */
+    uint8_t           *buffer;                    /*!<  This is the single record buffer.  This is used when updating a CSF record.  It's
+                                                        allocated (sizeof (CZMIL_CSF_Data) bytes so that a bad bit size can't blow it up) the
+                                                        first time a record is updated and freed when the file is closed.  */
     uint32_t          io_buffer_size;             /*!<  CSF I/O buffer size.  */
     uint32_t          io_buffer_address;          /*!<  Location within the I/O buffer at which we will place our next compressed
                                                         block of SBET data.  */
     uint8_t           *io_buffer;                 /*!<  The actual I/O buffer that will be allocated on creation/open and freed on close.  */
+    uint8_t           *map;                       /*!<  Memory mapped CSF file (CZMIL_READONLY_MMAP mode only, otherwise NULL).  */
+    int64_t           map_size;                   /*!<  Size of the memory mapped CSF file in bytes.  */
   } INTERNAL_CZMIL_CSF_STRUCT;
 
 
@@ -697,6 +901,19 @@ extern "C" {
   } INTERNAL_CZMIL_CAF_STRUCT;
 
 
+  /*!  Flightline set (see czmil_open_flightline_set).  This is just the handles of the CPF, CWF, and CSF files of one
+       flightline.  The CPF file shares the CIF handle of the CWF file.  */
+
+  typedef struct
+  {
+    uint8_t           open;                       /*!<  Set to 1 if the set handle is in use.  */
+    int32_t           cpf_hnd;                    /*!<  CPF file handle.  */
+    int32_t           cwf_hnd;                    /*!<  CWF file handle.  */
+    int32_t           csf_hnd;                    /*!<  CSF file handle.  */
+    int32_t           number_of_records;          /*!<  Number of shots (the same in all three files).  */
+  } INTERNAL_CZMIL_SET_STRUCT;
+
+
 
   /*  These are default constant values used for CIF index file packing/unpacking.  It would probably be best to leave these as they 
       are since this works out to 16 bytes per record.  Every system I know of uses an I/O buffer that is a multiple of 16 bytes.  */
@@ -710,6 +927,36 @@ extern "C" {
 #define CZMIL_CIF_IO_BUFFER_SIZE  (CWF_BUFFER_SIZE_BYTES + CPF_BUFFER_SIZE_BYTES + CIF_CWF_ADDRESS_BITS / 8 + CIF_CPF_ADDRESS_BITS / 8) * 262144
                                                   /*!<  Default CIF I/O buffer size.  This is 512 * 512 * 16 or 26.2 seconds of data at 10000
                                                         shots/sec  */
+#define CIF_INDEX_READ_GAP        64              /*!<  When reading the CIF records for a list of record numbers (czmil_read_c?f_records_by_index)
+                                                        record numbers that are no more than this many records apart are read with one read.  */
+#define CIF_INDEX_READ_MAX        4096            /*!<  Maximum number of CIF records read with one read by czmil_read_cif_records_by_index.  */
+#define CIF_INDEX_LOAD_RECORDS    65536           /*!<  Number of CIF records read with each read when loading a resident CIF index
+                                                        (czmil_load_cif_index).  This MUST be a multiple of CIF_INDEX_BLOCK_RECORDS.  */
+#define CIF_INDEX_BLOCK_SHIFT     4               /*!<  log2 of the number of records in each block of a resident CIF index.  */
+#define CIF_INDEX_BLOCK_RECORDS   (1 << CIF_INDEX_BLOCK_SHIFT)
+                                                  /*!<  Number of records in each block of a resident CIF index.  A lookup adds up at
+                                                        most CIF_INDEX_BLOCK_RECORDS - 1 buffer sizes.  */
+#define CIF_SCAN_BLOCK_SIZE       16777216        /*!<  Number of bytes read with each read when scanning a CWF or CPF file to regenerate its CIF
+                                                        file (czmil_scan_cif_sizes).  This MUST be a multiple of CIF_SCAN_ALIGNMENT.  */
+#define CIF_SCAN_ALIGNMENT        4096            /*!<  Scan reads start on a multiple of this many bytes.  */
+#define CIF_SCAN_RECORDS          65536           /*!<  Number of records scanned from each file before they are written to the CIF file.  */
+#define CZMIL_INDEX_READ_GAP      65536           /*!<  When reading a list of CWF or CPF records (czmil_read_c?f_records_by_index) records that
+                                                        are no more than this many bytes apart in the file are read with one read.  */
+#define CZMIL_INDEX_READ_MAX      4194304         /*!<  Maximum number of bytes read with one read by czmil_read_c?f_buffers_by_index (unless a
+                                                        single record is bigger, which can't happen).  */
+#define CZMIL_HUGE_PAGE_SIZE      2097152         /*!<  Transparent huge page size.  Pooled I/O buffers at least this big are aligned to it when
+                                                        huge pages are turned on (see czmil_set_io_buffer_huge_pages).  */
+
+
+  /*  Handle types for czmil_new_handle.  */
+
+#define CZMIL_CWF_HANDLE          0
+#define CZMIL_CPF_HANDLE          1
+#define CZMIL_CSF_HANDLE          2
+#define CZMIL_CIF_HANDLE          3
+#define CZMIL_CAF_HANDLE          4
+#define CZMIL_SET_HANDLE          5
+#define CZMIL_HANDLE_TYPES        6
 
 
   /*  These are default constant values used for CAF audit file packing/unpacking.  */
@@ -723,6 +970,10 @@ extern "C" {
   {
     int32_t           czmil;                      /*!<  Last CZMIL error condition encountered.  */
     char              info[2048];                 /*!<  Text information to be printed out.  */
+    const char        *format;                    /*!<  Format for the text if it hasn't been built yet (see czmil_defer_error).  */
+    char              path[1024];                 /*!<  File name for the deferred text.  */
+    int32_t           recnum;                     /*!<  Record number for the deferred text.  */
+    int32_t           system_error;               /*!<  errno for the deferred text (0 if the format doesn't use it).  */
   } CZMIL_ERROR_STRUCT;
 
 
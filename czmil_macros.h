@@ -46,7 +46,13 @@ extern "C" {
 
 
 
-#define       CZMIL_MAX_FILES                      128       /*!<  Maximum number of open CZMIL files.  */
+#define       CZMIL_MAX_FILES                      128       /*!<  Initial number of CZMIL file handles of each type.  The handle
+                                                                       tables double in size whenever they fill up (up to
+                                                                       CZMIL_MAX_HANDLES) so this isn't a limit on the number of
+                                                                       open files.  */
+#define       CZMIL_MAX_HANDLES                    32768     /*!<  Maximum number of CZMIL file handles of each type that can be in use
+                                                                       at the same time.  This is far more files than the system will
+                                                                       let one program open.  */
 #define       CZMIL_MAX_PACKETS                    15        /*!<  Maximum number of 64 sample packets in a single waveform.  
                                                                    <b>** WARNING WARNING - NEVER DECREASE THIS NUMBER! - WARNING WARNING **</b>
                                                                    Because it is used in czmil.h as an array size.  */
@@ -60,6 +66,15 @@ extern "C" {
 #define       CZMIL_CPF_IO_BUFFER_SIZE             36000000  /*!<  Default CPF I/O buffer size.  */
 #define       CZMIL_CSF_IO_BUFFER_SIZE             15000000  /*!<  Default CSF I/O buffer size.  */
 #define       CZMIL_CAF_IO_BUFFER_SIZE             6000000   /*!<  Default CAF I/O buffer size.  */
+#define       CZMIL_CIF_MEMORY_BUDGET              1073741824LL  /*!<  Default total amount of memory (in bytes) that may be used to keep the
+                                                                       CIF indexes of open CPF and CWF files in memory (see
+                                                                       czmil_set_cif_memory_budget).  At about 5.5 bytes per shot this is
+                                                                       roughly 5 hours of 10 kHz data.  */
+#define       CZMIL_IO_BUFFER_BUDGET               268435456LL   /*!<  Default total amount of memory (in bytes) that may be held by the
+                                                                       pool of create/open I/O buffers (see czmil_set_io_buffer_budget).  This
+                                                                       is enough to keep the buffers for a CWF, CPF, and CSF file being
+                                                                       created (plus a few more) so they can be reused for the next
+                                                                       flightline.  */
 
 
   /*  Channel indexes.  */
@@ -75,6 +90,21 @@ extern "C" {
 #define       CZMIL_DEEP_CHANNEL                   8
 
 
+  /*  Channel masks (used with czmil_read_cwf_record_channels).  */
+
+#define       CZMIL_CHANNEL_MASK(c)                (1 << (c))  /*!<  Mask bit for channel index c.  */
+#define       CZMIL_ALL_SHALLOW_CHANNELS           0x07f      /*!<  CZMIL_SHALLOW_CHANNEL_1 through CZMIL_SHALLOW_CHANNEL_7.  */
+#define       CZMIL_ALL_CHANNELS                   0x1ff      /*!<  All nine channels.  */
+
+
+  /*  Storage needed for the samples, ranges, and packet numbers of a CZMIL_CWF_Packed_Data record with n packets.  That is,
+      64 two byte samples, a four byte range, and a one byte packet number per packet, rounded up to a multiple of 8 bytes so
+      that records can be stored back to back.  */
+
+#define       CZMIL_CWF_PACKED_SIZE(n)             ((((n) * 133) + 7) & ~7)
+#define       CZMIL_CWF_PACKED_MAX_SIZE            CZMIL_CWF_PACKED_SIZE (9 * CZMIL_MAX_PACKETS)
+
+
   /*  File open modes.  */
 
 #define       CZMIL_UPDATE                         0      /*!<  Open file for update.  */
@@ -86,6 +116,10 @@ extern "C" {
 #define       CZMIL_CWF_PROCESS_WAVEFORMS          3      /*!<  This mode is to be used only by Optech to open an existing CWF file for
                                                                 processing waveforms to produce the CPF file.  It will be converted to
                                                                 CZMIL_READONLY_SEQUENTIAL after some initial checking of files is done.  */
+#define       CZMIL_READONLY_MMAP                  4      /*!<  Open file for read only with the data and index files memory mapped.  Records
+                                                                are decoded straight from the mapping so there is no fseek/fread per record and
+                                                                no per handle I/O buffer.  On systems without mmap this behaves exactly like
+                                                                CZMIL_READONLY.  */
 
 
 #define       CZMIL_NEXT_RECORD                    -1     /*!<  Use this as the record number if you are appending to (i.e. creating) a CPF
@@ -355,6 +389,11 @@ extern "C" {
 #define       CZMIL_GCC_IGNORE_RETURN_VALUE_ERROR  -103  /*  gcc spits out warnings if you don't check the return value of certain functions.
                                                              Due to this I had to add return error checking on things that should never fail.
 							     You should never see this error!  */
+#define       CZMIL_CWF_PACKED_STORAGE_SIZE_ERROR  -104
+#define       CZMIL_CWF_UNKNOWN_PACKET_TYPE_ERROR  -105
+#define       CZMIL_SET_RECORD_COUNT_ERROR         -106
+#define       CZMIL_CURSOR_ERROR                   -107
+#define       CZMIL_CURSORS_OPEN_ERROR             -108
 
 
   /*  Supported local vertical datums.  These match the vertical datum values used in Generic Sensor Format (GSF).  */
@@ -149,6 +149,10 @@ extern "C" {
   CZMIL_DLL int32_t czmil_create_cpf_file (char *idl_path, int32_t path_length, CZMIL_CPF_Header *cpf_header, int32_t io_buffer_size);
   CZMIL_DLL int32_t czmil_create_csf_file (char *idl_path, int32_t path_length, CZMIL_CSF_Header *cpf_header, int32_t io_buffer_size);
 
+  CZMIL_DLL int32_t czmil_set_cwf_t0_key_interval (int32_t hnd, int32_t t0_key_interval);
+  CZMIL_DLL int32_t czmil_set_cwf_rice_packets (int32_t hnd, int32_t allow);
+  CZMIL_DLL int32_t czmil_set_cwf_cross_channel_packets (int32_t hnd, int32_t allow);
+
   CZMIL_DLL int32_t czmil_abort_cpf_file (int32_t hnd);
 
   CZMIL_DLL int32_t czmil_idl_open_cwf_file (char *idl_path, int32_t path_length, CZMIL_CWF_Header *cwf_header, int32_t mode);
@@ -38,7 +38,7 @@
 
 #ifndef CZMIL_VERSION
 
-#define     CZMIL_VERSION     "PFM Software - CZMIL library V3.17 - 08/28/19"
+#define     CZMIL_VERSION     "PFM Software - CZMIL library V3.37 - 10/17/26"
 
 #endif
 
@@ -485,4 +485,253 @@
 
     - I wasn't populating creation_software for CPF, CSF, and CWF on read.  DOH!
 
+
+    Version 3.18
+    10/16/26
+    PFM Software
+
+    - Added a sequential bit reader (CZMIL_BIT_READER, czmil_bit_read) with a 64 bit accumulator and replaced the
+      czmil_bit_unpack/bpos pairs in the CWF, CPF, CSF, CIF, and CAF record decoders with it.  The on-disk format
+      is unchanged.
+    - Added the matching sequential bit writer (CZMIL_BIT_WRITER, czmil_bit_write) and replaced the czmil_bit_pack/bpos
+      pairs in the CWF, CPF, CSF, CIF, and CAF record encoders with it.  Output is byte for byte identical.
+    - Added SSE4.2 and AVX2 kernels (selected at run time, with a scalar fallback) that unpack, remove the offset from, and
+      integrate all of the deltas of a CZMIL_FIRST_DIFFERENCE or CZMIL_SECOND_DIFFERENCE packet (and the T0 packet) at once
+      in czmil_uncompress_cwf_record.  Define CZMIL_NO_SIMD to build without them.
+    - czmil_compress_cwf_record now computes the first, second, and shallow central differences of each packet, along with
+      their minimums and maximums, in one SSE4.2/AVX2 (or scalar) pass (czmil_cwf_packet_analysis) to pick the compression
+      type.  The bit widths come from max - min instead of ORing the offset deltas (same result).  Output is unchanged.
+    - Added width specialized unpack kernels (czmil_unpack_0 through czmil_unpack_32, generated by CZMIL_UNPACK_KERNEL).
+      The kernel is picked once per packet for the CWF delta widths and once per handle on open/create for the CWF packet
+      number, range, and validity reason fields and the CPF number of returns field.
+    - Added czmil_read_cwf_record_channels to read a CWF record but only unpack the channels in a channel mask
+      (CZMIL_CHANNEL_MASK, CZMIL_ALL_CHANNELS).  The other channels are skipped using the packet type headers.
+    - Added the compact CZMIL_CWF_Packed_Data waveform structure (per channel packet counts and offsets plus one contiguous
+      array of samples in caller supplied storage) and czmil_read_cwf_record_packed/czmil_read_cwf_record_packed_array to
+      fill it without zeroing a full CZMIL_CWF_Data record.  Added CZMIL_CWF_PACKED_STORAGE_SIZE_ERROR.
+    - Split czmil_uncompress_cwf_record into czmil_uncompress_cwf_channel_header, czmil_uncompress_cwf_packet, and
+      czmil_uncompress_cwf_trailer so the CZMIL_CWF_Data and CZMIL_CWF_Packed_Data decoders share them.
+
+
+    Version 3.19
+    10/16/26
+    PFM Software
+
+    - Added the CZMIL_RICE_DIFFERENCE (4) CWF waveform packet compression type.  The first differences are zigzag
+      encoded and stored as adaptive Rice codes (see the description in czmil.h) so a single spike no longer sets the
+      delta width for the whole packet.  czmil_compress_cwf_record only uses it for a packet when it is smaller than
+      all of the other types.  CWF files are marked 3.19 by their version string and the type is only allowed in
+      3.19 or later files.
+    - Unknown (or not allowed for the file version) CWF packet compression types now return
+      CZMIL_CWF_UNKNOWN_PACKET_TYPE_ERROR instead of being silently ignored.
+
+
+    Version 3.20
+    10/16/26
+    PFM Software
+
+    - Added the CZMIL_CROSS_CHANNEL_DIFFERENCE (5) CWF waveform packet compression type.  Shallow channels 2 through 7
+      can now store a packet as differences from the packet with the same packet number in any earlier shallow channel
+      instead of only from the central shallow channel (type 3).  czmil_compress_cwf_record picks the reference channel
+      that needs the fewest bits and only uses the type when it gives a smaller packet.  The type is only allowed in
+      3.20 or later files.
+    - czmil_read_cwf_record_channels and the packed readers unpack every shallow channel before the last requested
+      shallow channel for 3.20 or later files since any of them may be a reference.
+
+
+    Version 3.21
+    10/16/26
+    PFM Software
+
+    - Added optional shot to shot prediction of the T0 waveform.  czmil_set_cwf_t0_key_interval (called after
+      czmil_create_cwf_file) sets the [T0 KEY INTERVAL] header field.  The T0 of every record that isn't a key record
+      (record number a multiple of the interval) may then be stored as differences from the previous record's T0.
+      czmil_compress_cwf_record only does this when it gives a smaller record.  The last unpacked T0 is kept so that
+      sequential reads cost nothing extra.  A random read unpacks the T0 of the records back to the last key record.
+
+
+    Version 3.22
+    10/16/26
+    PFM Software
+
+    - czmil_write_cwf_record_array now unpacks and compresses the records in parallel (when the library is compiled
+      with OpenMP) into separate buffers and then adds them to the file in the original order.  The CWF and CWI files
+      are exactly the same as the ones written by the serial path.  The number of threads can be set with
+      czmil_set_thread_count.  Without OpenMP everything is done serially, just like before.
+    - The unused bits at the end of each compressed CWF record are now always zeroed.
+
+
+    Version 3.23
+    10/16/26
+    PFM Software
+
+    - czmil_read_cwf_record_array and czmil_read_cpf_record_array now read all of the compressed records first and then
+      unpack them in parallel (when the library is compiled with OpenMP, see czmil_set_thread_count).  For CWF files that
+      use T0 prediction the records from each T0 key record to the next are unpacked in order by one thread.
+    - The CWF record unpacking functions no longer change the file handle or czmil_error (the T0 of the previous record
+      and the error information are passed in) and czmil_read_cpf_record has been split into czmil_read_cpf_buffer and
+      czmil_uncompress_cpf_record so that records can be unpacked in separate threads.
+
+
+    Version 3.24
+    10/16/26
+    PFM Software
+
+    - czmil_read_cwf_record_array and czmil_read_cpf_record_array now read the CIF records for the whole range with one
+      read (new internal function czmil_read_cif_records) and, when the CWF or CPF records are stored in order, read all
+      of the compressed records with one read as well.  This is done whether or not the library is using more than one
+      thread.
+
+    Version 3.25
+    10/16/26
+    PFM Software
+
+    - czmil_read_csf_record_array now reads the whole range of (fixed size) CSF records with one read and unpacks them,
+      in parallel when the library is compiled with OpenMP.  The unpacking code from czmil_read_csf_record has been moved
+      to czmil_uncompress_csf_record.
+
+    Version 3.26
+    10/16/26
+    PFM Software
+
+    - Added czmil_read_cwf_records_by_index and czmil_read_cpf_records_by_index.  These read a list of record numbers (in
+      any order).  The CIF records are read in blocks, the CWF or CPF records are sorted by file address and records that
+      are close together are read with one read, and the records are returned in the caller's order.
+
+    Version 3.27
+    10/16/26
+    PFM Software
+
+    - Added flightline sets (czmil_open_flightline_set, czmil_close_flightline_set, czmil_get_flightline_set_handles).  A set
+      is the CPF, CWF, and CSF files of a flightline opened together.  czmil_read_shot reads the CPF, CWF, and CSF records
+      of a shot with one CIF lookup and czmil_read_shot_array does the same for a range of shots (one CIF read and one read
+      per file) and then asks the operating system to read ahead the next range.
+    - Added CZMIL_SET_RECORD_COUNT_ERROR.
+    - Split czmil_read_cwf_buffer and czmil_read_cpf_buffer into the CIF lookup and czmil_read_c?f_buffer_at, and the
+      block readers and unpackers used by the record array functions into czmil_read_c?f_buffers_at and
+      czmil_uncompress_c?f_buffers so that they can be shared.
+
+    Version 3.28
+    10/16/26
+    PFM Software
+
+    - Added the CZMIL_READONLY_MMAP open mode for CPF, CWF, and CSF files.  The file and its CIF file are memory mapped
+      and records are decoded straight from the mapping so there's no fseek/fread per record and no setvbuf buffer.  The
+      record array, by index, and shot array functions unpack from the mapping without copying the buffers at all.  If
+      the file can't be mapped (or on Windows) it behaves exactly like CZMIL_READONLY.
+    - czmil_open_flightline_set opens the CWF and CSF files CZMIL_READONLY_MMAP if mode is CZMIL_READONLY_MMAP.
+
+    Version 3.29
+    10/16/26
+    PFM Software
+
+    - The CIF index is now read and decoded into memory when a CPF or CWF file is opened CZMIL_READONLY or CZMIL_UPDATE so
+      that a CIF lookup is an array access instead of an fseek, fread, and bit unpack.
+    - Added czmil_set_cif_memory_budget and CZMIL_CIF_MEMORY_BUDGET to limit the total memory used by resident CIF
+      indexes.  Files whose index won't fit read it from disk like they always did.
+
+    Version 3.30
+    10/16/26
+    PFM Software
+
+    - The resident CIF index now keeps the CWF and CPF buffer sizes for every record and the addresses of the first record
+      in each block of 16 records.  Other addresses are the block address plus the sizes of the records before them in the
+      block.  Blocks whose records aren't stored back to back keep all of their addresses.  This cuts the memory used from
+      20 bytes per shot to about 5.5.
+
+    Version 3.31
+    10/16/26
+    PFM Software
+
+    - Regenerating a missing CIF file (czmil_create_cif_file) now reads the CWF and CPF files in 16MB aligned blocks and
+      follows the record buffer sizes in memory instead of reading every record with fread.  The two files are scanned at
+      the same time if more than one thread is allowed.  The CIF records are still written through the CIF I/O buffer and
+      progress is still reported through the progress callback.
+    - A bad buffer size or a truncated CWF or CPF file now returns CZMIL_CWF_CREATE_CIF_ERROR or CZMIL_CPF_CREATE_CIF_ERROR
+      instead of CZMIL_GCC_IGNORE_RETURN_VALUE_ERROR.
+
+    Version 3.32
+    10/16/26
+    PFM Software
+
+    - The create, open, and close functions (and czmil_open_flightline_set and czmil_close_flightline_set) may now be called
+      from any thread at any time.  They are serialized by a recursive mutex on the handle tables.
+    - The handle tables are no longer fixed at CZMIL_MAX_FILES entries.  They are arrays of pointers to internal structures
+      that double in size when they fill up.  The structures never move so reads and writes on open handles don't need
+      any locking.
+    - Fixed the CIF handle sharing between a CWF file and its associated CPF file.  The check for an already open associated
+      file was looking at the wrong handle and closing either file closed the shared CIF file out from under the other one.
+
+
+    Version 3.33
+    10/16/26
+    PFM Software
+
+    - The error information (czmil_error) is now kept per thread so reader threads working on different handles no longer
+      overwrite each other's errors.  czmil_get_errno, czmil_strerror, and czmil_perror report the calling thread's last
+      error.
+    - The messages for invalid record numbers, reads past the end of the file, read errors, and CIF/CPF buffer size
+      mismatches are no longer built with sprintf when the error happens.  The pieces are saved and the text is built by
+      czmil_strerror when it's asked for (see czmil_defer_error).
+
+
+    Version 3.34
+    10/16/26
+    PFM Software
+
+    - Added czmil_open_cwf_cursor and czmil_open_cpf_cursor.  A cursor is a new file handle on a CWF or CPF file that is already
+      open CZMIL_READONLY or CZMIL_READONLY_MMAP.  It shares the file, the parsed header, and the CIF index with the original
+      handle and reads with pread so that many threads can read one file without each of them opening it.  Cursors are
+      closed with czmil_close_cwf_file or czmil_close_cpf_file.
+    - Added CZMIL_CURSOR_ERROR and CZMIL_CURSORS_OPEN_ERROR.
+
+
+    Version 3.35
+    10/16/26
+    PFM Software
+
+    - The application defined header fields buffer in the internal CWF, CPF, and CSF structures is now allocated when a file
+      with application defined fields is read (or a field is added) and grows as needed instead of being a full header sized
+      array in every handle.  The CPF single record buffer is allocated when the file is opened and the CSF single record
+      buffer the first time a record is updated.  All of them are freed on close.  This takes each CWF, CPF, and CSF handle
+      from about 130KB to between 2KB and 15KB.
+
+
+    Version 3.36
+    10/16/26
+    PFM Software
+
+    - The I/O buffers used when creating files or opening them CZMIL_READONLY_SEQUENTIAL now come from a pool and go back to it
+      when the file is closed so the next create or open reuses them instead of allocating and freeing them every time.
+      Added czmil_set_io_buffer_budget to limit the pool (CZMIL_IO_BUFFER_BUDGET by default) and
+      czmil_set_io_buffer_huge_pages to back big buffers with transparent huge pages on Linux.
+    - Added czmil_open_cwf_file_with_buffer_size, czmil_open_cpf_file_with_buffer_size, and
+      czmil_open_csf_file_with_buffer_size to set the I/O buffer size of a sequential open.
+    - Fixed the CIF I/O buffer being freed using the CPF/CWF handle instead of the CIF handle in czmil_close_cpf_file and
+      czmil_abort_cpf_file.
+
+
+    Version 3.37
+    10/17/26
+    PFM Software
+
+    - Rice coded CWF packets (CZMIL_RICE_DIFFERENCE) are no longer used in every new CWF file.  Versions 3.19 through
+      3.36 marked those files with a newer minor version only and older libraries quietly misread them.  They are now
+      only used if czmil_set_cwf_rice_packets is called when the file is created.  That writes [RICE PACKETS] to the
+      header and "CZMIL extended library V4.xx" to [VERSION] so that older libraries refuse to open the file (they
+      only open files whose version string has "CZMIL library" in it).  Files created without it can still be read by
+      older libraries.
+    - Cross channel difference CWF packets (CZMIL_CROSS_CHANNEL_DIFFERENCE) are opt-in the same way.  They are only used
+      if czmil_set_cwf_cross_channel_packets is called when the file is created, which writes [CROSS CHANNEL PACKETS] to
+      the header and the extended version string.  Files written by 3.20 through 3.36 are still read as before.
+    - CWF files created with a T0 key interval (czmil_set_cwf_t0_key_interval) also get the extended version string.
+      The T0 prediction flag changes the record layout and libraries older than 3.21 would misparse every record.
+    - Fixed the CWF newer file version warning using the CPF path for the file name.
+    - The create, open, and close functions no longer hold the handle table lock for their whole run.  They only lock
+      it to get or give back a handle, to change the pooled I/O buffers or the resident CIF index memory budget, and to
+      count the users of a shared CIF handle.  Opening, regenerating a CIF file, and closing are done without it so a
+      slow open no longer holds up opens and closes in other threads.
+    - The handle tables are now fixed size arrays of pointers (CZMIL_MAX_HANDLES entries) so they never move while
+      another thread is looking at them.  Only the structures for new handles are allocated as the tables grow.
+
 </pre>*/
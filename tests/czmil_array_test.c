@@ -0,0 +1,275 @@
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/*  Multi-threaded array reader test.
+
+    Creates a CWF/CPF/CSF set and reads it with czmil_read_c?f_record_array and czmil_read_c?f_records_by_index using one
+    thread and then several threads (see czmil_set_thread_count).  Both have to match a record by record read.  The library
+    has to be compiled with OpenMP (NBMakefile does by default) for the second pass to actually run in parallel.
+
+    Usage: czmil_array_test [DIRECTORY]   (the test files are created in DIRECTORY, /tmp by default)  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "czmil.h"
+
+
+#define RECORDS   2000
+
+
+static int32_t create_files (const char *dir, const char *name, uint32_t seed)
+{
+  int32_t i, c, j, cwf_hnd, cpf_hnd, csf_hnd;
+  char path[1024];
+  CZMIL_CWF_Header cwf_header;
+  CZMIL_CPF_Header cpf_header;
+  CZMIL_CSF_Header csf_header;
+  CZMIL_WAVEFORM_RAW_Data wave;
+  CZMIL_CSF_Data csf;
+  static CZMIL_CPF_Data rec;
+  static uint8_t data[11070];
+
+
+  srand (seed);
+
+
+  sprintf (path, "%s/%s.cwf", dir, name);
+
+  memset (&cwf_header, 0, sizeof (cwf_header));
+  if ((cwf_hnd = czmil_create_cwf_file (path, strlen (path), &cwf_header, 0)) < 0) return (cwf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&wave, 0, sizeof (wave));
+      wave.shot_id = rand () % 1000000;
+      wave.timestamp = 1500000000000000ULL + i * 100;
+      for (c = 0 ; c < 9 ; c++) wave.number_of_packets[c] = 1;
+
+      if (czmil_write_cwf_record (cwf_hnd, &wave, data) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_cwf_file (cwf_hnd) < 0) return (czmil_get_errno ());
+
+
+  if ((cwf_hnd = czmil_open_cwf_file (path, &cwf_header, CZMIL_CWF_PROCESS_WAVEFORMS)) < 0) return (cwf_hnd);
+
+  sprintf (path, "%s/%s.cpf", dir, name);
+
+  memset (&cpf_header, 0, sizeof (cpf_header));
+  cpf_header.base_lat = 30.0;
+  cpf_header.base_lon = -88.0;
+  cpf_header.null_z_value = -998.0;
+
+  if ((cpf_hnd = czmil_create_cpf_file (path, strlen (path), &cpf_header, 0)) < 0) return (cpf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&rec, 0, sizeof (rec));
+      rec.timestamp = 1500000000000000ULL + i * 100;
+      rec.off_nadir_angle = (rand () % 200) / 10.0;
+      rec.reference_latitude = 30.0 + (rand () % 10000) * 1e-6;
+      rec.reference_longitude = -88.0 + (rand () % 10000) * 1e-6;
+      rec.water_level = 1.5;
+      rec.kd = 0.1;
+      rec.laser_energy = 2.0;
+
+      for (c = 0 ; c < 7 ; c++)
+        {
+          rec.bare_earth_latitude[c] = rec.reference_latitude;
+          rec.bare_earth_longitude[c] = rec.reference_longitude;
+          rec.bare_earth_elevation[c] = -(rand () % 100) / 10.0;
+        }
+
+      for (c = 0 ; c < 9 ; c++)
+        {
+          rec.returns[c] = rand () % 4;
+          for (j = 0 ; j < rec.returns[c] ; j++)
+            {
+              rec.channel[c][j].latitude = rec.reference_latitude + 1e-6 * j;
+              rec.channel[c][j].longitude = rec.reference_longitude + 1e-6 * j;
+              rec.channel[c][j].elevation = -(rand () % 1000) / 10.0;
+              rec.channel[c][j].interest_point = rand () % 300;
+            }
+        }
+
+      if (czmil_write_cpf_record (cpf_hnd, CZMIL_NEXT_RECORD, &rec) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_cpf_file (cpf_hnd) < 0 || czmil_close_cwf_file (cwf_hnd) < 0) return (czmil_get_errno ());
+
+
+  sprintf (path, "%s/%s.csf", dir, name);
+
+  memset (&csf_header, 0, sizeof (csf_header));
+  csf_header.base_lat = 30.0;
+  csf_header.base_lon = -88.0;
+
+  if ((csf_hnd = czmil_create_csf_file (path, strlen (path), &csf_header, 0)) < 0) return (csf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&csf, 0, sizeof (csf));
+      csf.timestamp = 1500000000000000ULL + i * 100;
+      csf.scan_angle = (rand () % 3600) / 10.0;
+      csf.latitude = 30.0 + (rand () % 10000) * 1e-6;
+      csf.longitude = -88.0 + (rand () % 10000) * 1e-6;
+      csf.altitude = (rand () % 5000) / 10.0;
+
+      if (czmil_write_csf_record (csf_hnd, CZMIL_NEXT_RECORD, &csf) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_csf_file (csf_hnd) < 0) return (czmil_get_errno ());
+
+
+  return (0);
+}
+
+
+/*  Reads every record one at a time, then with the array and by index functions using "threads" threads, and compares them.  */
+
+static int32_t check (const char *dir, int32_t threads)
+{
+  int32_t i, hnd, failures = 0, *recnums;
+  char path[1024];
+  CZMIL_CWF_Header cwf_header;
+  CZMIL_CPF_Header cpf_header;
+  CZMIL_CSF_Header csf_header;
+  CZMIL_CWF_Data *cwf_ref, *cwf_array;
+  CZMIL_CPF_Data *cpf_ref, *cpf_array;
+  CZMIL_CSF_Data *csf_ref, *csf_array;
+
+
+  czmil_set_thread_count (threads);
+
+
+  /*  Records in a scrambled order for the by index readers.  */
+
+  recnums = (int32_t *) malloc (RECORDS * sizeof (int32_t));
+  for (i = 0 ; i < RECORDS ; i++) recnums[i] = (int32_t) (((int64_t) i * 7919) % RECORDS);
+
+
+  /*  The arrays are cleared first so that structure padding compares equal.  */
+
+  cpf_ref = (CZMIL_CPF_Data *) calloc (RECORDS, sizeof (CZMIL_CPF_Data));
+  cpf_array = (CZMIL_CPF_Data *) calloc (RECORDS, sizeof (CZMIL_CPF_Data));
+
+  sprintf (path, "%s/czmil_array_test.cpf", dir);
+  if ((hnd = czmil_open_cpf_file (path, &cpf_header, CZMIL_READONLY)) < 0) return (-1);
+
+  for (i = 0 ; i < RECORDS ; i++) if (czmil_read_cpf_record (hnd, i, &cpf_ref[i]) < 0) return (-1);
+
+  if (czmil_read_cpf_record_array (hnd, 0, RECORDS, cpf_array) != RECORDS || memcmp (cpf_ref, cpf_array, RECORDS * sizeof (CZMIL_CPF_Data)))
+    {
+      fprintf (stderr, "czmil_read_cpf_record_array mismatch (%d threads)\n", threads);
+      failures++;
+    }
+
+  memset (cpf_array, 0, RECORDS * sizeof (CZMIL_CPF_Data));
+  if (czmil_read_cpf_records_by_index (hnd, RECORDS, recnums, cpf_array) != RECORDS) failures++;
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      if (memcmp (&cpf_ref[recnums[i]], &cpf_array[i], sizeof (CZMIL_CPF_Data)))
+        {
+          fprintf (stderr, "czmil_read_cpf_records_by_index mismatch at %d (%d threads)\n", i, threads);
+          failures++;
+          break;
+        }
+    }
+
+  czmil_close_cpf_file (hnd);
+  free (cpf_ref);
+  free (cpf_array);
+
+
+  /*  CWF records are big so we only read some of them.  */
+
+  cwf_ref = (CZMIL_CWF_Data *) calloc (RECORDS / 4, sizeof (CZMIL_CWF_Data));
+  cwf_array = (CZMIL_CWF_Data *) calloc (RECORDS / 4, sizeof (CZMIL_CWF_Data));
+
+  sprintf (path, "%s/czmil_array_test.cwf", dir);
+  if ((hnd = czmil_open_cwf_file (path, &cwf_header, CZMIL_READONLY)) < 0) return (-1);
+
+  for (i = 0 ; i < RECORDS / 4 ; i++) if (czmil_read_cwf_record (hnd, RECORDS / 2 + i, &cwf_ref[i]) < 0) return (-1);
+
+  if (czmil_read_cwf_record_array (hnd, RECORDS / 2, RECORDS / 4, cwf_array) != RECORDS / 4 ||
+      memcmp (cwf_ref, cwf_array, (RECORDS / 4) * sizeof (CZMIL_CWF_Data)))
+    {
+      fprintf (stderr, "czmil_read_cwf_record_array mismatch (%d threads)\n", threads);
+      failures++;
+    }
+
+  czmil_close_cwf_file (hnd);
+  free (cwf_ref);
+  free (cwf_array);
+
+
+  csf_ref = (CZMIL_CSF_Data *) calloc (RECORDS, sizeof (CZMIL_CSF_Data));
+  csf_array = (CZMIL_CSF_Data *) calloc (RECORDS, sizeof (CZMIL_CSF_Data));
+
+  sprintf (path, "%s/czmil_array_test.csf", dir);
+  if ((hnd = czmil_open_csf_file (path, &csf_header, CZMIL_READONLY)) < 0) return (-1);
+
+  for (i = 0 ; i < RECORDS ; i++) if (czmil_read_csf_record (hnd, i, &csf_ref[i]) < 0) return (-1);
+
+  if (czmil_read_csf_record_array (hnd, 0, RECORDS, csf_array) != RECORDS || memcmp (csf_ref, csf_array, RECORDS * sizeof (CZMIL_CSF_Data)))
+    {
+      fprintf (stderr, "czmil_read_csf_record_array mismatch (%d threads)\n", threads);
+      failures++;
+    }
+
+  czmil_close_csf_file (hnd);
+  free (csf_ref);
+  free (csf_array);
+
+
+  free (recnums);
+
+  printf ("%d thread%s %s\n", threads, threads == 1 ? " " : "s", failures ? "FAILED" : "OK");
+
+  return (failures);
+}
+
+
+int main (int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : "/tmp";
+  int32_t failures = 0;
+
+
+  if (create_files (dir, "czmil_array_test", 1))
+    {
+      czmil_perror ();
+      return (1);
+    }
+
+
+  if (check (dir, 1)) failures++;
+  if (check (dir, 8)) failures++;
+
+
+  printf ("czmil_array_test %s\n", failures ? "FAILED" : "OK");
+
+  return (failures != 0);
+}
@@ -0,0 +1,215 @@
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/*  Randomized bit reader test.
+
+    Compares the sequential bit reader (czmil_bit_read, czmil_double_bit_read, czmil_bit_skip, czmil_bit_read_array, and the
+    width specialized unpack kernels) with czmil_bit_unpack and czmil_double_bit_unpack.  Each trial fills a random length
+    buffer with random bytes, starts the reader at a random bit offset, and does a random mix of reads, checking every value
+    and czmil_bit_reader_tell against the old code.  The reads run past the end of the buffer so the zero padding is checked
+    too (czmil_bit_unpack reads those bits from a zero filled copy of the buffer).  The reader gets an exact size heap copy
+    of the buffer so that a sanitizer build will catch it reading past the end.
+
+    The bit functions are static so this includes czmil.c directly instead of linking with the library.
+
+    Usage: czmil_bit_reader_test [TRIALS [SEED]]  */
+
+
+#ifndef _LARGEFILE64_SOURCE
+#define _LARGEFILE64_SOURCE
+#endif
+
+#include "czmil.c"
+
+
+#define MAX_BYTES      96
+#define PAD_BYTES      64
+
+
+static uint64_t state;
+
+
+static uint64_t next_random ()
+{
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+
+  return (state);
+}
+
+
+/*  Random width with the edge cases (0, 1, and the maximum) showing up more often than they would otherwise.  */
+
+static uint32_t random_width (uint32_t min, uint32_t max)
+{
+  switch (next_random () % 8)
+    {
+    case 0:
+      return (min);
+
+    case 1:
+      return (max);
+
+    default:
+      return (min + (uint32_t) (next_random () % (max - min + 1)));
+    }
+}
+
+
+static int32_t trial (int32_t num)
+{
+  uint8_t padded[MAX_BYTES + PAD_BYTES], *exact;
+  uint32_t size, start, bpos, limit, width, count, i, op, value, values[64];
+  uint64_t dvalue;
+  CZMIL_BIT_READER reader;
+  int32_t failures = 0;
+
+
+  size = 1 + (uint32_t) (next_random () % MAX_BYTES);
+
+  memset (padded, 0, sizeof (padded));
+  for (i = 0 ; i < size ; i++) padded[i] = (uint8_t) next_random ();
+
+  exact = (uint8_t *) malloc (size);
+  memcpy (exact, padded, size);
+
+
+  /*  Read up to 32 bytes past the end of the buffer.  */
+
+  limit = (size + 32) * 8;
+  start = (uint32_t) (next_random () % (size * 8));
+  bpos = start;
+
+  czmil_bit_reader_init (&reader, exact, size, start);
+
+
+  while (bpos < limit - 64)
+    {
+      op = (uint32_t) (next_random () % 5);
+
+      switch (op)
+        {
+        case 0:
+          width = random_width (0, 32);
+          value = czmil_bit_read (&reader, width);
+          if (value != czmil_bit_unpack (padded, bpos, width))
+            {
+              fprintf (stderr, "Trial %d : czmil_bit_read of %u bits at bit %u (size %u) returned 0x%x, czmil_bit_unpack 0x%x\n", num,
+                       width, bpos, size, value, czmil_bit_unpack (padded, bpos, width));
+              failures++;
+            }
+          bpos += width;
+          break;
+
+        case 1:
+          width = random_width (33, 64);
+          dvalue = czmil_double_bit_read (&reader, width);
+          if (dvalue != czmil_double_bit_unpack (padded, bpos, width))
+            {
+              fprintf (stderr, "Trial %d : czmil_double_bit_read of %u bits at bit %u (size %u) failed\n", num, width, bpos, size);
+              failures++;
+            }
+          bpos += width;
+          break;
+
+        case 2:
+          width = random_width (0, 100);
+          czmil_bit_skip (&reader, width);
+          bpos += width;
+          break;
+
+        case 3:
+        case 4:
+          width = random_width (0, 32);
+          count = 1 + (uint32_t) (next_random () % 64);
+          if (bpos + count * width >= limit) count = 1;
+
+
+          /*  Alternate between the generic array reader and the width specialized kernel.  */
+
+          if (op == 3)
+            {
+              czmil_bit_read_array (&reader, count, width, values);
+            }
+          else
+            {
+              (*czmil_unpack_select (width)) (&reader, count, values);
+            }
+
+          for (i = 0 ; i < count ; i++)
+            {
+              if (values[i] != czmil_bit_unpack (padded, bpos, width))
+                {
+                  fprintf (stderr, "Trial %d : %s value %u of %u bits at bit %u (size %u) returned 0x%x, czmil_bit_unpack 0x%x\n", num,
+                           op == 3 ? "czmil_bit_read_array" : "czmil_unpack_select", i, width, bpos, size, values[i],
+                           czmil_bit_unpack (padded, bpos, width));
+                  failures++;
+                  break;
+                }
+              bpos += width;
+            }
+          bpos += (count - i) * width;
+          break;
+        }
+
+
+      /*  The reader can only tell us where it is while it's still inside the buffer.  */
+
+      if (bpos <= size * 8 && czmil_bit_reader_tell (&reader) != bpos)
+        {
+          fprintf (stderr, "Trial %d : czmil_bit_reader_tell returned %u, expected %u (size %u)\n", num, czmil_bit_reader_tell (&reader),
+                   bpos, size);
+          failures++;
+        }
+
+      if (failures) break;
+    }
+
+
+  free (exact);
+
+  return (failures);
+}
+
+
+int main (int argc, char **argv)
+{
+  int32_t i, trials, failures = 0;
+
+
+  trials = argc > 1 ? atoi (argv[1]) : 100000;
+  state = argc > 2 ? strtoull (argv[2], NULL, 0) : 0x9e3779b97f4a7c15ULL;
+  if (!state) state = 1;
+
+
+  for (i = 0 ; i < trials ; i++)
+    {
+      if (trial (i)) failures++;
+      if (failures >= 10) break;
+    }
+
+
+  printf ("czmil_bit_reader_test %s (%d trials)\n", failures ? "FAILED" : "OK", i);
+
+  return (failures != 0);
+}
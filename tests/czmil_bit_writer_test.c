@@ -0,0 +1,201 @@
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/*  Randomized bit writer test.
+
+    Checks that the sequential bit writer (czmil_bit_write, czmil_double_bit_write, and czmil_bit_writer_flush) produces
+    the same bytes as czmil_bit_pack and czmil_double_bit_pack.  Each trial makes a random list of fields (widths from 0
+    to 64 bits, values with bits set above the width), fills two copies of a buffer with the same random bytes, and packs
+    the fields at a random start bit into one with czmil_bit_pack and into the other with the writer.  The two buffers
+    have to match byte for byte once the bits after the last field in the last byte of the czmil_bit_pack copy have been
+    cleared, since czmil_bit_writer_flush zeroes them.  That includes the bits ahead of the start bit in the first byte
+    (czmil_bit_writer_init) and the bytes after the last field, which the writer must not touch.  The writer gets an
+    exact size heap buffer so that a sanitizer build will catch it writing past the end.
+
+    The bit functions are static so this includes czmil.c directly instead of linking with the library.
+
+    Usage: czmil_bit_writer_test [TRIALS [SEED]]  */
+
+
+#ifndef _LARGEFILE64_SOURCE
+#define _LARGEFILE64_SOURCE
+#endif
+
+#include "czmil.c"
+
+
+#define MAX_FIELDS     64
+
+
+static uint64_t state;
+
+
+static uint64_t next_random ()
+{
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+
+  return (state);
+}
+
+
+/*  Random width with the edge cases (0, 1, and the maximum) showing up more often than they would otherwise.  */
+
+static uint32_t random_width (uint32_t min, uint32_t max)
+{
+  switch (next_random () % 8)
+    {
+    case 0:
+      return (min);
+
+    case 1:
+      return (max);
+
+    default:
+      return (min + (uint32_t) (next_random () % (max - min + 1)));
+    }
+}
+
+
+static int32_t trial (int32_t num)
+{
+  uint32_t width[MAX_FIELDS], start, bpos, total, size, count, i;
+  uint64_t value[MAX_FIELDS];
+  uint8_t *packed, *written;
+  CZMIL_BIT_WRITER writer;
+  int32_t failures = 0;
+
+
+  count = (uint32_t) (next_random () % (MAX_FIELDS + 1));
+  start = (uint32_t) (next_random () % 64);
+
+  total = start;
+  for (i = 0 ; i < count ; i++)
+    {
+      /*  Mostly 32 bit or smaller fields with a few 64 bit ones (czmil_double_bit_write).  */
+
+      if (next_random () % 4)
+        {
+          width[i] = random_width (0, 32);
+        }
+      else
+        {
+          width[i] = random_width (33, 64);
+        }
+
+      value[i] = next_random ();
+      total += width[i];
+    }
+
+
+  /*  Always leave at least one byte that the fields don't touch.  */
+
+  size = total / 8 + 1;
+
+  packed = (uint8_t *) malloc (size);
+  written = (uint8_t *) malloc (size);
+
+  for (i = 0 ; i < size ; i++) packed[i] = written[i] = (uint8_t) next_random ();
+
+
+  bpos = start;
+  for (i = 0 ; i < count ; i++)
+    {
+      if (width[i] > 32)
+        {
+          czmil_double_bit_pack (packed, bpos, width[i], (int64_t) value[i]);
+        }
+      else
+        {
+          czmil_bit_pack (packed, bpos, width[i], (int32_t) (uint32_t) value[i]);
+        }
+      bpos += width[i];
+    }
+
+
+  /*  czmil_bit_writer_flush zeroes the unused bits at the end of the last byte.  */
+
+  if (total % 8) packed[total / 8] &= mask[total % 8];
+
+
+  czmil_bit_writer_init (&writer, written, start);
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (width[i] > 32)
+        {
+          czmil_double_bit_write (&writer, width[i], (int64_t) value[i]);
+        }
+      else
+        {
+          czmil_bit_write (&writer, width[i], (int32_t) (uint32_t) value[i]);
+        }
+    }
+
+  if ((bpos = czmil_bit_writer_flush (&writer)) != total)
+    {
+      fprintf (stderr, "Trial %d : czmil_bit_writer_flush returned %u, expected %u\n", num, bpos, total);
+      failures++;
+    }
+
+
+  for (i = 0 ; i < size ; i++)
+    {
+      if (packed[i] != written[i])
+        {
+          fprintf (stderr, "Trial %d : byte %u of %u (start bit %u, %u fields, %u bits) is 0x%02x, czmil_bit_pack has 0x%02x\n", num, i,
+                   size, start, count, total, written[i], packed[i]);
+          failures++;
+          break;
+        }
+    }
+
+
+  free (packed);
+  free (written);
+
+  return (failures);
+}
+
+
+int main (int argc, char **argv)
+{
+  int32_t i, trials, failures = 0;
+
+
+  trials = argc > 1 ? atoi (argv[1]) : 100000;
+  state = argc > 2 ? strtoull (argv[2], NULL, 0) : 0x9e3779b97f4a7c15ULL;
+  if (!state) state = 1;
+
+
+  for (i = 0 ; i < trials ; i++)
+    {
+      if (trial (i)) failures++;
+      if (failures >= 10) break;
+    }
+
+
+  printf ("czmil_bit_writer_test %s (%d trials)\n", failures ? "FAILED" : "OK", i);
+
+  return (failures != 0);
+}
@@ -0,0 +1,293 @@
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/*  Parallel CWF writer test.
+
+    Writes the same raw waveform records to a CWF file with czmil_write_cwf_record (one record at a time) and with
+    czmil_write_cwf_record_array using 1 and 8 threads (see czmil_set_thread_count), with and without T0 prediction (see
+    czmil_set_cwf_t0_key_interval) and Rice coded and cross channel difference packets (see czmil_set_cwf_rice_packets and
+    czmil_set_cwf_cross_channel_packets).  The CWF and CWI files written by the array writer have to be byte for byte
+    identical to the serial ones after the ASCII headers (which hold creation times).  There are more records than
+    CWF_WRITE_BATCH so more than one batch gets compressed.  The files that use the newer packet types must not have
+    "CZMIL library" in [VERSION] (so that older libraries refuse to open them) and have to have major version 4.  This
+    library still has to open them.
+
+    Usage: czmil_cwf_write_test [DIRECTORY]   (the test files are created in DIRECTORY, /tmp by default)  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "czmil.h"
+#include "czmil_optech.h"
+
+
+#define RECORDS        1500
+#define RAW_BYTES      (9 * CZMIL_MAX_PACKETS * (8 + 8 + 64 * 10) / 8)
+
+
+static CZMIL_WAVEFORM_RAW_Data waveform[RECORDS];
+static uint8_t *raw_data;
+
+
+/*  Packs 'numbits' bits of 'value' into 'buffer' at bit 'start', high order bit first (the same as czmil_bit_pack).  */
+
+static void pack (uint8_t *buffer, uint32_t start, uint32_t numbits, uint32_t value)
+{
+  uint32_t i, bit;
+
+
+  for (i = 0 ; i < numbits ; i++)
+    {
+      bit = start + i;
+
+      if ((value >> (numbits - 1 - i)) & 1)
+        {
+          buffer[bit / 8] |= (uint8_t) (0x80 >> (bit % 8));
+        }
+      else
+        {
+          buffer[bit / 8] &= (uint8_t) ~(0x80 >> (bit % 8));
+        }
+    }
+}
+
+
+/*  Makes waveforms that look enough like the real thing that all of the packet compression types get used.  */
+
+static void make_records ()
+{
+  int32_t i, c, j, k, bpos;
+  uint8_t *data;
+
+
+  srand (11);
+
+  raw_data = (uint8_t *) calloc (RECORDS, RAW_BYTES);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&waveform[i], 0, sizeof (CZMIL_WAVEFORM_RAW_Data));
+      waveform[i].shot_id = i;
+      waveform[i].timestamp = 1500000000000000ULL + i * 100;
+      waveform[i].scan_angle = (float) (i % 360);
+
+      for (k = 0 ; k < 64 ; k++) pack (waveform[i].T0, k * 10, 10, 100 + (k > 10 && k < 20 ? 600 - 40 * abs (k - 15) : 0) + rand () % 5);
+
+      data = &raw_data[(int64_t) i * RAW_BYTES];
+      bpos = 0;
+
+      for (c = 0 ; c < 9 ; c++)
+        {
+          waveform[i].number_of_packets[c] = 1 + (i + c) % 3;
+
+          for (j = 0 ; j < CZMIL_MAX_PACKETS ; j++, bpos += 8) pack (data, bpos, 8, j);
+          for (j = 0 ; j < CZMIL_MAX_PACKETS ; j++, bpos += 8) pack (data, bpos, 8, j * 2);
+
+          for (j = 0 ; j < CZMIL_MAX_PACKETS ; j++)
+            {
+              for (k = 0 ; k < 64 ; k++, bpos += 10)
+                {
+                  /*  A smooth pulse with some noise and the odd spike.  */
+
+                  pack (data, bpos, 10, (200 + c * 20 + (k < 32 ? k * 12 : (64 - k) * 12) + rand () % 8 + (rand () % 50 ? 0 : 300)) % 1024);
+                }
+            }
+        }
+    }
+}
+
+
+/*  Writes the records to DIRECTORY/NAME.cwf.  threads < 0 means use czmil_write_cwf_record for each record.  */
+
+static int32_t write_file (const char *dir, const char *name, int32_t threads, int32_t t0_key_interval, int32_t extended)
+{
+  char path[1024];
+  int32_t i, hnd;
+  CZMIL_CWF_Header cwf_header;
+
+
+  sprintf (path, "%s/%s.cwf", dir, name);
+
+  memset (&cwf_header, 0, sizeof (cwf_header));
+
+  if ((hnd = czmil_create_cwf_file (path, strlen (path), &cwf_header, 0)) < 0) return (hnd);
+
+  if (czmil_set_cwf_t0_key_interval (hnd, t0_key_interval) < 0) return (czmil_get_errno ());
+  if (czmil_set_cwf_rice_packets (hnd, extended) < 0) return (czmil_get_errno ());
+  if (czmil_set_cwf_cross_channel_packets (hnd, extended) < 0) return (czmil_get_errno ());
+
+  if (threads < 0)
+    {
+      for (i = 0 ; i < RECORDS ; i++)
+        {
+          if (czmil_write_cwf_record (hnd, &waveform[i], &raw_data[(int64_t) i * RAW_BYTES]) < 0) return (czmil_get_errno ());
+        }
+    }
+  else
+    {
+      czmil_set_thread_count (threads);
+
+      if (czmil_write_cwf_record_array (hnd, RECORDS, waveform, raw_data) != RECORDS) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_cwf_file (hnd) < 0) return (czmil_get_errno ());
+
+  return (0);
+}
+
+
+/*  Reads everything after the first "skip" bytes of a file.  */
+
+static uint8_t *read_file (const char *path, long skip, long *size)
+{
+  FILE *fp;
+  uint8_t *buffer;
+
+
+  if ((fp = fopen (path, "rb")) == NULL)
+    {
+      perror (path);
+      return (NULL);
+    }
+
+  fseek (fp, 0, SEEK_END);
+  *size = ftell (fp) - skip;
+  fseek (fp, skip, SEEK_SET);
+
+  buffer = (uint8_t *) malloc (*size);
+  if (fread (buffer, *size, 1, fp) != 1) *size = -1;
+
+  fclose (fp);
+
+  return (buffer);
+}
+
+
+static int32_t compare_files (const char *dir, const char *name_a, const char *name_b, const char *ext, long skip)
+{
+  char path[1024];
+  uint8_t *a, *b;
+  long size_a, size_b;
+  int32_t ret;
+
+
+  sprintf (path, "%s/%s.%s", dir, name_a, ext);
+  if ((a = read_file (path, skip, &size_a)) == NULL) return (-1);
+
+  sprintf (path, "%s/%s.%s", dir, name_b, ext);
+  if ((b = read_file (path, skip, &size_b)) == NULL) return (-1);
+
+  ret = (size_a < 0 || size_a != size_b || memcmp (a, b, size_a)) ? -1 : 0;
+
+  printf ("%-28s %s %s\n", name_b, ext, ret ? "FAILED" : "OK");
+
+  free (a);
+  free (b);
+
+  return (ret);
+}
+
+
+/*  Opens DIRECTORY/NAME.cwf and checks the version string in the header.  */
+
+static int32_t check_version (const char *dir, const char *name, uint16_t expected, int32_t extended)
+{
+  char path[1024];
+  int32_t hnd, ret;
+  uint16_t major_version, minor_version;
+  CZMIL_CWF_Header cwf_header;
+
+
+  sprintf (path, "%s/%s.cwf", dir, name);
+
+  if ((hnd = czmil_open_cwf_file (path, &cwf_header, CZMIL_READONLY)) < 0)
+    {
+      czmil_perror ();
+      return (-1);
+    }
+
+  czmil_get_version_numbers (cwf_header.version, &major_version, &minor_version);
+
+  ret = (major_version != expected || (strstr (cwf_header.version, "CZMIL library") == NULL) != extended) ? -1 : 0;
+
+  printf ("%-28s %s %s\n", name, cwf_header.version, ret ? "FAILED" : "OK");
+
+  czmil_close_cwf_file (hnd);
+
+  return (ret);
+}
+
+
+int main (int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : "/tmp";
+  int32_t interval, extended, threads, failures = 0;
+  uint16_t major_version, minor_version;
+  char serial[128], array[128];
+
+
+  make_records ();
+
+  czmil_get_version_numbers (czmil_get_version (), &major_version, &minor_version);
+
+
+  /*  Plain files, then files with T0 prediction and the newer packet types.  */
+
+  for (interval = 0 ; interval <= 16 ; interval += 16)
+    {
+      extended = interval ? 1 : 0;
+
+      sprintf (serial, "czmil_cwf_write_test_%d", interval);
+
+      if (write_file (dir, serial, -1, interval, extended))
+        {
+          czmil_perror ();
+          return (1);
+        }
+
+      if (check_version (dir, serial, extended ? 4 : major_version, extended)) failures++;
+
+      for (threads = 1 ; threads <= 8 ; threads += 7)
+        {
+          sprintf (array, "czmil_cwf_write_test_%d_%d", interval, threads);
+
+          if (write_file (dir, array, threads, interval, extended))
+            {
+              czmil_perror ();
+              return (1);
+            }
+
+
+          /*  The CWF header is 131072 bytes and the CWI (CIF) header is 16384 bytes.  */
+
+          if (compare_files (dir, serial, array, "cwf", 131072)) failures++;
+          if (compare_files (dir, serial, array, "cwi", 16384)) failures++;
+        }
+    }
+
+
+  printf ("czmil_cwf_write_test %s\n", failures ? "FAILED" : "OK");
+
+  return (failures != 0);
+}
@@ -0,0 +1,274 @@
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/*  CPF read I/O benchmark.
+
+    Creates a CWF/CPF pair and then reads the CPF records on the handle returned by czmil_open_cpf_file (which reads with
+    fseek and fread, see czmil_fread) and on a cursor opened on that handle (which reads with pread, see
+    czmil_open_cpf_cursor).  Each is timed reading:
+
+      - every record in order, one czmil_read_cpf_record call per record
+      - every record in order, RECORDS_PER_ARRAY records per czmil_read_cpf_record_array call
+      - RANDOM_READS records in a random order, one czmil_read_cpf_record call per record
+      - the same records with one czmil_read_cpf_records_by_index call per RECORDS_PER_ARRAY records
+
+    For each one it prints the number of records read per second and the number of read system calls made (the syscr
+    field of /proc/self/io, -1 if the system doesn't have it).  lseek calls aren't counted in syscr.  The file was just
+    written so it is (almost certainly) in the page cache and this measures the library and the system calls, not the disk.
+    This isn't run by "make test", use "make -f NBMakefile bench".
+
+    Usage: czmil_io_bench [DIRECTORY]   (the files are created in DIRECTORY, /tmp by default)  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "czmil.h"
+
+
+#define RECORDS             100000
+#define RANDOM_READS        20000
+#define RECORDS_PER_ARRAY   1000
+
+
+#define SEQUENTIAL          0
+#define ARRAY               1
+#define RANDOM              2
+#define BY_INDEX            3
+
+
+static char cpf_path[1024], cwf_path[1024];
+static CZMIL_CPF_Data record[RECORDS_PER_ARRAY];
+static int32_t random_recnum[RANDOM_READS];
+
+
+static double now ()
+{
+  struct timespec ts;
+
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ((double) ts.tv_sec + (double) ts.tv_nsec * 1.0e-9);
+}
+
+
+/*  Number of read system calls this process has made so far.  */
+
+static int64_t read_syscalls ()
+{
+  FILE *fp;
+  char line[128];
+  long long syscr = -1;
+
+
+  if ((fp = fopen ("/proc/self/io", "r")) == NULL) return (-1);
+
+  while (fgets (line, sizeof (line), fp) != NULL)
+    {
+      if (sscanf (line, "syscr: %lld", &syscr) == 1) break;
+    }
+
+  fclose (fp);
+
+  return ((int64_t) syscr);
+}
+
+
+static int32_t create_files (const char *dir)
+{
+  int32_t i, c, j, cwf_hnd, cpf_hnd;
+  CZMIL_CWF_Header cwf_header;
+  CZMIL_CPF_Header cpf_header;
+  CZMIL_WAVEFORM_RAW_Data wave;
+  static uint8_t data[11070];
+
+
+  sprintf (cwf_path, "%s/czmil_io_bench.cwf", dir);
+  sprintf (cpf_path, "%s/czmil_io_bench.cpf", dir);
+
+  srand (3);
+
+  memset (&cwf_header, 0, sizeof (cwf_header));
+  if ((cwf_hnd = czmil_create_cwf_file (cwf_path, strlen (cwf_path), &cwf_header, 0)) < 0) return (cwf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&wave, 0, sizeof (wave));
+      wave.shot_id = i;
+      wave.timestamp = 1500000000000000ULL + i * 100;
+      for (c = 0 ; c < 9 ; c++) wave.number_of_packets[c] = 1;
+
+      if (czmil_write_cwf_record (cwf_hnd, &wave, data) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_cwf_file (cwf_hnd) < 0) return (czmil_get_errno ());
+
+
+  /*  The CPF file is created with the CWF file open in CZMIL_CWF_PROCESS_WAVEFORMS mode (that's what builds the CIF file).  */
+
+  if ((cwf_hnd = czmil_open_cwf_file (cwf_path, &cwf_header, CZMIL_CWF_PROCESS_WAVEFORMS)) < 0) return (cwf_hnd);
+
+  memset (&cpf_header, 0, sizeof (cpf_header));
+  cpf_header.base_lat = 30.0;
+  cpf_header.base_lon = -88.0;
+  cpf_header.null_z_value = -998.0;
+
+  if ((cpf_hnd = czmil_create_cpf_file (cpf_path, strlen (cpf_path), &cpf_header, 0)) < 0) return (cpf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&record[0], 0, sizeof (CZMIL_CPF_Data));
+      record[0].timestamp = 1500000000000000ULL + i * 100;
+      record[0].off_nadir_angle = 20.0;
+      record[0].reference_latitude = 30.0 + i * 1e-6;
+      record[0].reference_longitude = -88.0 + i * 1e-6;
+      record[0].water_level = 1.5;
+      record[0].kd = 0.1;
+      record[0].laser_energy = 2.0;
+
+      for (c = 0 ; c < 7 ; c++)
+        {
+          record[0].bare_earth_latitude[c] = record[0].reference_latitude;
+          record[0].bare_earth_longitude[c] = record[0].reference_longitude;
+          record[0].bare_earth_elevation[c] = -5.0;
+        }
+
+      for (c = 0 ; c < 9 ; c++)
+        {
+          record[0].returns[c] = rand () % 4;
+          for (j = 0 ; j < record[0].returns[c] ; j++)
+            {
+              record[0].channel[c][j].latitude = record[0].reference_latitude + 1e-6 * j;
+              record[0].channel[c][j].longitude = record[0].reference_longitude + 1e-6 * j;
+              record[0].channel[c][j].elevation = -(rand () % 1000) / 10.0;
+              record[0].channel[c][j].interest_point = rand () % 300;
+            }
+        }
+
+      if (czmil_write_cpf_record (cpf_hnd, CZMIL_NEXT_RECORD, &record[0]) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_cpf_file (cpf_hnd) < 0 || czmil_close_cwf_file (cwf_hnd) < 0) return (czmil_get_errno ());
+
+
+  for (i = 0 ; i < RANDOM_READS ; i++) random_recnum[i] = (int32_t) (((int64_t) rand () * RAND_MAX + rand ()) % RECORDS);
+
+
+  return (0);
+}
+
+
+/*  Reads the records on "hnd" the way "how" says to and prints the results.  */
+
+static int32_t run (const char *name, int32_t hnd, int32_t how)
+{
+  int32_t i, count, records = (how == SEQUENTIAL || how == ARRAY) ? RECORDS : RANDOM_READS;
+  int64_t syscr;
+  double start;
+
+
+  syscr = read_syscalls ();
+  start = now ();
+
+  for (i = 0 ; i < records ; i += count)
+    {
+      count = 1;
+
+      switch (how)
+        {
+        case SEQUENTIAL:
+          if (czmil_read_cpf_record (hnd, i, &record[0]) < 0) return (-1);
+          break;
+
+        case ARRAY:
+          count = records - i < RECORDS_PER_ARRAY ? records - i : RECORDS_PER_ARRAY;
+          if (czmil_read_cpf_record_array (hnd, i, count, record) != count) return (-1);
+          break;
+
+        case RANDOM:
+          if (czmil_read_cpf_record (hnd, random_recnum[i], &record[0]) < 0) return (-1);
+          break;
+
+        case BY_INDEX:
+          count = records - i < RECORDS_PER_ARRAY ? records - i : RECORDS_PER_ARRAY;
+          if (czmil_read_cpf_records_by_index (hnd, count, &random_recnum[i], record) != count) return (-1);
+          break;
+        }
+    }
+
+  start = now () - start;
+  if (syscr >= 0) syscr = read_syscalls () - syscr;
+
+  printf ("%-40s %8d %14.0f %14lld\n", name, records, records / start, (long long) syscr);
+
+  return (0);
+}
+
+
+int main (int argc, char **argv)
+{
+  int32_t hnd, cursor, i, ret = 0;
+  CZMIL_CPF_Header cpf_header;
+  static const char *how_name[4] = {"per record, in order", "record array, in order", "per record, random", "by index, random"};
+  char name[128];
+
+
+  if (create_files (argc > 1 ? argv[1] : "/tmp"))
+    {
+      czmil_perror ();
+      return (1);
+    }
+
+  if ((hnd = czmil_open_cpf_file (cpf_path, &cpf_header, CZMIL_READONLY)) < 0 || (cursor = czmil_open_cpf_cursor (hnd)) < 0)
+    {
+      czmil_perror ();
+      return (1);
+    }
+
+
+  /*  One untimed pass so that the first timed read doesn't pay for anything the other ones don't.  */
+
+  for (i = 0 ; i < RECORDS ; i++) czmil_read_cpf_record (cursor, i, &record[0]);
+
+
+  printf ("\n%-40s %8s %14s %14s\n", "CPF reads", "records", "records/sec", "read syscalls");
+
+  for (i = SEQUENTIAL ; i <= BY_INDEX && !ret ; i++)
+    {
+      sprintf (name, "handle (fread), %s", how_name[i]);
+      ret = run (name, hnd, i);
+
+      sprintf (name, "cursor (pread), %s", how_name[i]);
+      if (!ret) ret = run (name, cursor, i);
+    }
+
+  if (ret) czmil_perror ();
+
+  czmil_close_cpf_file (cursor);
+  czmil_close_cpf_file (hnd);
+
+
+  return (ret != 0);
+}
@@ -0,0 +1,247 @@
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/*  Pooled I/O buffer determinism test.
+
+    Creates a CWF/CPF/CSF/CAF set from one random seed, then a set from a different seed (which leaves its data in the pooled
+    I/O buffers), then the first set again.  The first and third sets have to be byte for byte identical after the ASCII
+    headers (which hold creation times).  Any bits that the writers don't explicitly set (e.g. the pad bits at the end of
+    a packed record) would pick up the second set's data from the reused buffers and show up as a mismatch.
+
+    Usage: czmil_pool_test [DIRECTORY]   (the test files are created in DIRECTORY, /tmp by default)  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "czmil.h"
+
+
+#define RECORDS   2000
+
+
+static int32_t create_files (const char *dir, const char *name, uint32_t seed)
+{
+  int32_t i, c, j, cwf_hnd, cpf_hnd, csf_hnd, caf_hnd;
+  char path[1024];
+  CZMIL_CWF_Header cwf_header;
+  CZMIL_CPF_Header cpf_header;
+  CZMIL_CSF_Header csf_header;
+  CZMIL_CAF_Header caf_header;
+  CZMIL_WAVEFORM_RAW_Data wave;
+  CZMIL_CSF_Data csf;
+  CZMIL_CAF_Data caf;
+  static CZMIL_CPF_Data rec;
+  static uint8_t data[11070];
+
+
+  srand (seed);
+
+
+  sprintf (path, "%s/%s.cwf", dir, name);
+
+  memset (&cwf_header, 0, sizeof (cwf_header));
+  if ((cwf_hnd = czmil_create_cwf_file (path, strlen (path), &cwf_header, 0)) < 0) return (cwf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&wave, 0, sizeof (wave));
+      wave.shot_id = rand () % 1000000;
+      wave.timestamp = 1500000000000000ULL + i * 100;
+      for (c = 0 ; c < 9 ; c++) wave.number_of_packets[c] = 1;
+
+      if (czmil_write_cwf_record (cwf_hnd, &wave, data) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_cwf_file (cwf_hnd) < 0) return (czmil_get_errno ());
+
+
+  if ((cwf_hnd = czmil_open_cwf_file (path, &cwf_header, CZMIL_CWF_PROCESS_WAVEFORMS)) < 0) return (cwf_hnd);
+
+  sprintf (path, "%s/%s.cpf", dir, name);
+
+  memset (&cpf_header, 0, sizeof (cpf_header));
+  cpf_header.base_lat = 30.0;
+  cpf_header.base_lon = -88.0;
+  cpf_header.null_z_value = -998.0;
+
+  if ((cpf_hnd = czmil_create_cpf_file (path, strlen (path), &cpf_header, 0)) < 0) return (cpf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&rec, 0, sizeof (rec));
+      rec.timestamp = 1500000000000000ULL + i * 100;
+      rec.off_nadir_angle = (rand () % 200) / 10.0;
+      rec.reference_latitude = 30.0 + (rand () % 10000) * 1e-6;
+      rec.reference_longitude = -88.0 + (rand () % 10000) * 1e-6;
+      rec.water_level = 1.5;
+      rec.kd = 0.1;
+      rec.laser_energy = 2.0;
+
+      for (c = 0 ; c < 7 ; c++)
+        {
+          rec.bare_earth_latitude[c] = rec.reference_latitude;
+          rec.bare_earth_longitude[c] = rec.reference_longitude;
+          rec.bare_earth_elevation[c] = -(rand () % 100) / 10.0;
+        }
+
+      for (c = 0 ; c < 9 ; c++)
+        {
+          rec.returns[c] = rand () % 4;
+          for (j = 0 ; j < rec.returns[c] ; j++)
+            {
+              rec.channel[c][j].latitude = rec.reference_latitude + 1e-6 * j;
+              rec.channel[c][j].longitude = rec.reference_longitude + 1e-6 * j;
+              rec.channel[c][j].elevation = -(rand () % 1000) / 10.0;
+              rec.channel[c][j].interest_point = rand () % 300;
+            }
+        }
+
+      if (czmil_write_cpf_record (cpf_hnd, CZMIL_NEXT_RECORD, &rec) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_cpf_file (cpf_hnd) < 0 || czmil_close_cwf_file (cwf_hnd) < 0) return (czmil_get_errno ());
+
+
+  sprintf (path, "%s/%s.csf", dir, name);
+
+  memset (&csf_header, 0, sizeof (csf_header));
+  csf_header.base_lat = 30.0;
+  csf_header.base_lon = -88.0;
+
+  if ((csf_hnd = czmil_create_csf_file (path, strlen (path), &csf_header, 0)) < 0) return (csf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&csf, 0, sizeof (csf));
+      csf.timestamp = 1500000000000000ULL + i * 100;
+      csf.scan_angle = (rand () % 3600) / 10.0;
+      csf.latitude = 30.0 + (rand () % 10000) * 1e-6;
+      csf.longitude = -88.0 + (rand () % 10000) * 1e-6;
+      csf.altitude = (rand () % 5000) / 10.0;
+
+      if (czmil_write_csf_record (csf_hnd, CZMIL_NEXT_RECORD, &csf) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_csf_file (csf_hnd) < 0) return (czmil_get_errno ());
+
+
+  sprintf (path, "%s/%s.caf", dir, name);
+
+  memset (&caf_header, 0, sizeof (caf_header));
+
+  if ((caf_hnd = czmil_create_caf_file (path, &caf_header)) < 0) return (caf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&caf, 0, sizeof (caf));
+      caf.shot_id = i;
+      caf.channel_number = rand () % 9;
+      caf.optech_classification = rand () % 16;
+      caf.interest_point = (rand () % 3000) / 10.0;
+      caf.number_of_returns = rand () % 4 + 1;
+      caf.return_number = rand () % caf.number_of_returns;
+
+      if (czmil_write_caf_record (caf_hnd, &caf) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_caf_file (caf_hnd) < 0) return (czmil_get_errno ());
+
+
+  return (0);
+}
+
+
+/*  Compares two files after the first "skip" bytes.  */
+
+static int32_t compare_files (const char *dir, const char *name_a, const char *name_b, const char *ext, long skip)
+{
+  char path_a[1024], path_b[1024];
+  FILE *fp_a, *fp_b;
+  int32_t a, b, ret = 0;
+  long pos;
+
+
+  sprintf (path_a, "%s/%s.%s", dir, name_a, ext);
+  sprintf (path_b, "%s/%s.%s", dir, name_b, ext);
+
+  if ((fp_a = fopen (path_a, "rb")) == NULL || (fp_b = fopen (path_b, "rb")) == NULL)
+    {
+      perror (ext);
+      return (-1);
+    }
+
+  fseek (fp_a, skip, SEEK_SET);
+  fseek (fp_b, skip, SEEK_SET);
+
+  for (pos = skip ; ; pos++)
+    {
+      a = fgetc (fp_a);
+      b = fgetc (fp_b);
+
+      if (a != b)
+        {
+          fprintf (stderr, "%s files differ at byte %ld\n", ext, pos);
+          ret = -1;
+          break;
+        }
+
+      if (a == EOF) break;
+    }
+
+  fclose (fp_a);
+  fclose (fp_b);
+
+  printf ("%-4s %s\n", ext, ret ? "FAILED" : "OK");
+
+  return (ret);
+}
+
+
+int main (int argc, char **argv)
+{
+  const char *dir = argc > 1 ? argv[1] : "/tmp";
+  int32_t failures = 0;
+
+
+  if (create_files (dir, "czmil_pool_test_a", 1) || create_files (dir, "czmil_pool_test_b", 2) ||
+      create_files (dir, "czmil_pool_test_c", 1))
+    {
+      czmil_perror ();
+      return (1);
+    }
+
+
+  /*  The CWF, CPF, and CSF ASCII headers are 131072 bytes, the CIF and CAF headers are 16384 bytes.  */
+
+  if (compare_files (dir, "czmil_pool_test_a", "czmil_pool_test_c", "cwf", 131072)) failures++;
+  if (compare_files (dir, "czmil_pool_test_a", "czmil_pool_test_c", "cpf", 131072)) failures++;
+  if (compare_files (dir, "czmil_pool_test_a", "czmil_pool_test_c", "csf", 131072)) failures++;
+  if (compare_files (dir, "czmil_pool_test_a", "czmil_pool_test_c", "cif", 16384)) failures++;
+  if (compare_files (dir, "czmil_pool_test_a", "czmil_pool_test_c", "caf", 16384)) failures++;
+
+
+  printf ("czmil_pool_test %s\n", failures ? "FAILED" : "OK");
+
+  return (failures != 0);
+}
@@ -0,0 +1,313 @@
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/*  Concurrent open/read/close stress test.
+
+    Creates a small CWF/CPF pair and then has THREADS threads each open the same pair over and over, read records in a
+    scrambled order, check them against a single threaded reference read, and close the files again.  This is the "open the
+    file again in each thread" pattern that the Thread Safety section of czmil.h says is safe.  It is run with
+    CZMIL_READONLY, with CZMIL_READONLY and the resident CIF index turned off (czmil_set_cif_memory_budget (0)), and with
+    CZMIL_READONLY_MMAP.  It also reads a flightline set and a cursor in each thread.
+
+    Usage: czmil_thread_test [DIRECTORY]   (the test files are created in DIRECTORY, /tmp by default)  */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "czmil.h"
+
+
+#define RECORDS   3000
+#define THREADS   8
+#define LOOPS     12
+#define READS     400
+
+
+static char cpf_path[1024], cwf_path[1024];
+static CZMIL_CPF_Data ref[RECORDS];
+static int32_t mode, failures = 0;
+
+
+static void fail (const char *what, int32_t thread, int32_t recnum)
+{
+  if (__sync_fetch_and_add (&failures, 1) < 10) fprintf (stderr, "%s mismatch (thread %d, record %d, mode %d)\n", what, thread, recnum, mode);
+}
+
+
+static int32_t create_files (const char *dir)
+{
+  int32_t i, c, j, cwf_hnd, cpf_hnd;
+  char csf_path[1024];
+  CZMIL_CWF_Header cwf_header;
+  CZMIL_CPF_Header cpf_header;
+  CZMIL_CSF_Header csf_header;
+  CZMIL_WAVEFORM_RAW_Data wave;
+  CZMIL_CSF_Data csf;
+  static CZMIL_CPF_Data rec;
+  static uint8_t data[11070];
+
+
+  sprintf (cwf_path, "%s/czmil_thread_test.cwf", dir);
+  sprintf (cpf_path, "%s/czmil_thread_test.cpf", dir);
+  sprintf (csf_path, "%s/czmil_thread_test.csf", dir);
+
+  srand (7);
+
+  memset (&cwf_header, 0, sizeof (cwf_header));
+  if ((cwf_hnd = czmil_create_cwf_file (cwf_path, strlen (cwf_path), &cwf_header, 0)) < 0) return (cwf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&wave, 0, sizeof (wave));
+      wave.shot_id = i;
+      wave.timestamp = 1500000000000000ULL + i * 100;
+      for (c = 0 ; c < 9 ; c++) wave.number_of_packets[c] = 1;
+
+      if (czmil_write_cwf_record (cwf_hnd, &wave, data) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_cwf_file (cwf_hnd) < 0) return (czmil_get_errno ());
+
+
+  /*  The CPF file is created with the CWF file open in CZMIL_CWF_PROCESS_WAVEFORMS mode (that's what builds the CIF file).  */
+
+  if ((cwf_hnd = czmil_open_cwf_file (cwf_path, &cwf_header, CZMIL_CWF_PROCESS_WAVEFORMS)) < 0) return (cwf_hnd);
+
+  memset (&cpf_header, 0, sizeof (cpf_header));
+  cpf_header.base_lat = 30.0;
+  cpf_header.base_lon = -88.0;
+  cpf_header.null_z_value = -998.0;
+
+  if ((cpf_hnd = czmil_create_cpf_file (cpf_path, strlen (cpf_path), &cpf_header, 0)) < 0) return (cpf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&rec, 0, sizeof (rec));
+      rec.timestamp = 1500000000000000ULL + i * 100;
+      rec.off_nadir_angle = 20.0;
+      rec.reference_latitude = 30.0 + i * 1e-6;
+      rec.reference_longitude = -88.0 + i * 1e-6;
+      rec.water_level = 1.5;
+      rec.kd = 0.1;
+      rec.laser_energy = 2.0;
+
+      for (c = 0 ; c < 7 ; c++)
+        {
+          rec.bare_earth_latitude[c] = rec.reference_latitude;
+          rec.bare_earth_longitude[c] = rec.reference_longitude;
+          rec.bare_earth_elevation[c] = -5.0;
+        }
+
+      for (c = 0 ; c < 9 ; c++)
+        {
+          rec.returns[c] = rand () % 4;
+          for (j = 0 ; j < rec.returns[c] ; j++)
+            {
+              rec.channel[c][j].latitude = rec.reference_latitude + 1e-6 * j;
+              rec.channel[c][j].longitude = rec.reference_longitude + 1e-6 * j;
+              rec.channel[c][j].elevation = -(rand () % 1000) / 10.0;
+              rec.channel[c][j].interest_point = rand () % 300;
+            }
+        }
+
+      if (czmil_write_cpf_record (cpf_hnd, CZMIL_NEXT_RECORD, &rec) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_cpf_file (cpf_hnd) < 0 || czmil_close_cwf_file (cwf_hnd) < 0) return (czmil_get_errno ());
+
+
+  /*  A CSF file so that the files can be opened as a flightline set.  */
+
+  memset (&csf_header, 0, sizeof (csf_header));
+  csf_header.base_lat = 30.0;
+  csf_header.base_lon = -88.0;
+  if ((cpf_hnd = czmil_create_csf_file (csf_path, strlen (csf_path), &csf_header, 0)) < 0) return (cpf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&csf, 0, sizeof (csf));
+      csf.timestamp = 1500000000000000ULL + i * 100;
+      csf.latitude = 30.0 + i * 1e-6;
+      csf.longitude = -88.0 + i * 1e-6;
+
+      if (czmil_write_csf_record (cpf_hnd, CZMIL_NEXT_RECORD, &csf) < 0) return (czmil_get_errno ());
+    }
+
+  if (czmil_close_csf_file (cpf_hnd) < 0) return (czmil_get_errno ());
+
+
+  /*  Reference records from a single threaded read.  */
+
+  if ((cpf_hnd = czmil_open_cpf_file (cpf_path, &cpf_header, CZMIL_READONLY)) < 0) return (cpf_hnd);
+
+  for (i = 0 ; i < RECORDS ; i++)
+    {
+      memset (&ref[i], 0, sizeof (CZMIL_CPF_Data));
+      if (czmil_read_cpf_record (cpf_hnd, i, &ref[i]) < 0) return (czmil_get_errno ());
+      if (fabs (ref[i].reference_latitude - (30.0 + i * 1e-6)) > 1e-6) return (-1);
+    }
+
+  czmil_close_cpf_file (cpf_hnd);
+
+
+  return (0);
+}
+
+
+static void *reader (void *arg)
+{
+  int32_t thread = (int32_t) (intptr_t) arg, loop, i, recnum, cpf_hnd, cwf_hnd, set_hnd, cursor;
+  CZMIL_CPF_Header cpf_header;
+  CZMIL_CWF_Header cwf_header;
+  static __thread CZMIL_CPF_Data cpf_record;
+  static __thread CZMIL_CWF_Data cwf_record;
+  static __thread CZMIL_CSF_Data csf_record;
+
+
+  for (loop = 0 ; loop < LOOPS ; loop++)
+    {
+      /*  Alternate which file of the pair gets opened first.  */
+
+      if ((loop + thread) & 1)
+        {
+          cpf_hnd = czmil_open_cpf_file (cpf_path, &cpf_header, mode);
+          cwf_hnd = czmil_open_cwf_file (cwf_path, &cwf_header, mode);
+        }
+      else
+        {
+          cwf_hnd = czmil_open_cwf_file (cwf_path, &cwf_header, mode);
+          cpf_hnd = czmil_open_cpf_file (cpf_path, &cpf_header, mode);
+        }
+
+      if (cpf_hnd < 0 || cwf_hnd < 0)
+        {
+          fail ("open", thread, -1);
+          return (NULL);
+        }
+
+      for (i = 0 ; i < READS ; i++)
+        {
+          recnum = (i * 7919 + thread * 613 + loop * 97) % RECORDS;
+
+          memset (&cpf_record, 0, sizeof (cpf_record));
+          if (czmil_read_cpf_record (cpf_hnd, recnum, &cpf_record) < 0 || memcmp (&cpf_record, &ref[recnum], sizeof (cpf_record)))
+            fail ("cpf", thread, recnum);
+
+          if (czmil_read_cwf_record (cwf_hnd, recnum, &cwf_record) < 0 || cwf_record.shot_id != (uint32_t) recnum)
+            fail ("cwf", thread, recnum);
+        }
+
+
+      /*  A cursor on this thread's CPF handle.  */
+
+      if (mode != CZMIL_READONLY_SEQUENTIAL && (cursor = czmil_open_cpf_cursor (cpf_hnd)) >= 0)
+        {
+          recnum = (thread * 389 + loop) % RECORDS;
+
+          memset (&cpf_record, 0, sizeof (cpf_record));
+          if (czmil_read_cpf_record (cursor, recnum, &cpf_record) < 0 || memcmp (&cpf_record, &ref[recnum], sizeof (cpf_record)))
+            fail ("cursor", thread, recnum);
+
+          czmil_close_cpf_file (cursor);
+        }
+
+      if (czmil_close_cwf_file (cwf_hnd) < 0 || czmil_close_cpf_file (cpf_hnd) < 0) fail ("close", thread, -1);
+
+
+      /*  And a flightline set (which shares one CIF handle between its CPF and CWF files).  */
+
+      if ((set_hnd = czmil_open_flightline_set (cpf_path, NULL, NULL, NULL, mode)) < 0)
+        {
+          fail ("set open", thread, -1);
+          return (NULL);
+        }
+
+      for (i = 0 ; i < READS / 4 ; i++)
+        {
+          recnum = (i * 4409 + thread * 101 + loop) % RECORDS;
+
+          memset (&cpf_record, 0, sizeof (cpf_record));
+          if (czmil_read_shot (set_hnd, recnum, &cpf_record, &cwf_record, &csf_record) < 0 ||
+              memcmp (&cpf_record, &ref[recnum], sizeof (cpf_record)) || cwf_record.shot_id != (uint32_t) recnum)
+            fail ("set", thread, recnum);
+        }
+
+      if (czmil_close_flightline_set (set_hnd) < 0) fail ("set close", thread, -1);
+    }
+
+  return (NULL);
+}
+
+
+static void run (int32_t open_mode, int64_t cif_budget, const char *name)
+{
+  pthread_t threads[THREADS];
+  int32_t i, before = failures;
+
+
+  mode = open_mode;
+  czmil_set_cif_memory_budget (cif_budget);
+
+  for (i = 0 ; i < THREADS ; i++) pthread_create (&threads[i], NULL, reader, (void *) (intptr_t) i);
+  for (i = 0 ; i < THREADS ; i++) pthread_join (threads[i], NULL);
+
+  printf ("%-40s %s\n", name, failures == before ? "OK" : "FAILED");
+}
+
+
+int main (int argc, char **argv)
+{
+  CZMIL_CPF_Header cpf_header;
+  int32_t hnd;
+
+
+  if (create_files (argc > 1 ? argv[1] : "/tmp"))
+    {
+      czmil_perror ();
+      return (1);
+    }
+
+  run (CZMIL_READONLY, CZMIL_CIF_MEMORY_BUDGET, "CZMIL_READONLY");
+  run (CZMIL_READONLY, 0, "CZMIL_READONLY (no resident CIF index)");
+  run (CZMIL_READONLY_MMAP, CZMIL_CIF_MEMORY_BUDGET, "CZMIL_READONLY_MMAP");
+  run (CZMIL_READONLY_MMAP, 0, "CZMIL_READONLY_MMAP (no resident CIF index)");
+
+
+  /*  Every handle should have been given back.  */
+
+  if ((hnd = czmil_open_cpf_file (cpf_path, &cpf_header, CZMIL_READONLY)) != 0)
+    {
+      fprintf (stderr, "Handle %d leaked\n", hnd);
+      failures++;
+    }
+
+  czmil_close_cpf_file (hnd);
+
+
+  printf ("czmil_thread_test %s\n", failures ? "FAILED" : "OK");
+
+  return (failures != 0);
+}
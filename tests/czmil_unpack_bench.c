@@ -0,0 +1,299 @@
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/*  Bit unpacking microbenchmark.
+
+    Times unpacking 64 value packets (the size of a CWF waveform packet) from a buffer of random bytes with:
+
+      - czmil_bit_unpack, one call per value (the old code)
+      - czmil_bit_read_array with the width passed in at run time
+      - the width specialized CZMIL_UNPACK_KERNEL kernels (picked with czmil_unpack_select)
+
+    and decoding 64 first difference deltas (unpack, remove the offset, and integrate) with:
+
+      - czmil_bit_unpack and a plain integration loop (the old code)
+      - czmil_delta_decode_scalar (the unpack kernels and a plain integration loop)
+      - czmil_delta_decode (the AVX2 or SSE4.2 kernel if the CPU has it, see czmil_simd_level)
+
+    Every method is checked against czmil_bit_unpack before it is timed.  The results are in millions of values per second.
+    This isn't run by "make test", use "make -f NBMakefile bench".
+
+    The bit functions are static so this includes czmil.c directly instead of linking with the library.
+
+    Usage: czmil_unpack_bench [PASSES]  */
+
+
+#ifndef _LARGEFILE64_SOURCE
+#define _LARGEFILE64_SOURCE
+#endif
+
+#include <time.h>
+
+#include "czmil.c"
+
+
+#define PACKET         64
+#define PACKETS        4096
+#define BUFFER_BYTES   (PACKETS * PACKET * 32 / 8 + 64)
+
+
+static uint8_t buffer[BUFFER_BYTES];
+static uint32_t values[PACKET];
+static uint16_t samples[PACKET + 1];
+static volatile uint32_t sink;
+
+
+static double now ()
+{
+  struct timespec ts;
+
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ((double) ts.tv_sec + (double) ts.tv_nsec * 1.0e-9);
+}
+
+
+/*  Millions of values per second for "passes" passes over the buffer since "start".  */
+
+static double rate (double start, int32_t passes)
+{
+  return ((double) passes * PACKETS * PACKET / (now () - start) * 1.0e-6);
+}
+
+
+static double unpack_old (uint32_t numbits, int32_t passes)
+{
+  int32_t pass, p, k;
+  uint32_t bpos;
+  double start = now ();
+
+
+  for (pass = 0 ; pass < passes ; pass++)
+    {
+      for (p = 0, bpos = 0 ; p < PACKETS ; p++)
+        {
+          for (k = 0 ; k < PACKET ; k++, bpos += numbits) values[k] = czmil_bit_unpack (buffer, bpos, numbits);
+
+          sink += values[PACKET - 1];
+        }
+    }
+
+  return (rate (start, passes));
+}
+
+
+static double unpack_array (uint32_t numbits, int32_t passes)
+{
+  int32_t pass, p;
+  CZMIL_BIT_READER reader;
+  double start = now ();
+
+
+  for (pass = 0 ; pass < passes ; pass++)
+    {
+      czmil_bit_reader_init (&reader, buffer, BUFFER_BYTES, 0);
+
+      for (p = 0 ; p < PACKETS ; p++)
+        {
+          czmil_bit_read_array (&reader, PACKET, numbits, values);
+
+          sink += values[PACKET - 1];
+        }
+    }
+
+  return (rate (start, passes));
+}
+
+
+static double unpack_kernel (uint32_t numbits, int32_t passes)
+{
+  int32_t pass, p;
+  CZMIL_BIT_READER reader;
+  double start = now ();
+
+
+  for (pass = 0 ; pass < passes ; pass++)
+    {
+      czmil_bit_reader_init (&reader, buffer, BUFFER_BYTES, 0);
+
+      for (p = 0 ; p < PACKETS ; p++)
+        {
+          (*czmil_unpack_select (numbits)) (&reader, PACKET, values);
+
+          sink += values[PACKET - 1];
+        }
+    }
+
+  return (rate (start, passes));
+}
+
+
+static double delta_old (uint32_t numbits, int32_t passes)
+{
+  int32_t pass, p, k;
+  uint32_t bpos;
+  int16_t offset = (int16_t) (1 << (numbits - 1));
+  double start = now ();
+
+
+  for (pass = 0 ; pass < passes ; pass++)
+    {
+      for (p = 0, bpos = 0 ; p < PACKETS ; p++)
+        {
+          samples[0] = 500;
+
+          for (k = 1 ; k <= PACKET ; k++, bpos += numbits)
+            samples[k] = (int16_t) (czmil_bit_unpack (buffer, bpos, numbits) - offset) + (int16_t) samples[k - 1];
+
+          sink += samples[PACKET];
+        }
+    }
+
+  return (rate (start, passes));
+}
+
+
+static double delta_new (uint32_t numbits, int32_t passes, int32_t simd)
+{
+  int32_t pass, p;
+  CZMIL_BIT_READER reader;
+  int16_t offset = (int16_t) (1 << (numbits - 1));
+  double start = now ();
+
+
+  for (pass = 0 ; pass < passes ; pass++)
+    {
+      czmil_bit_reader_init (&reader, buffer, BUFFER_BYTES, 0);
+
+      for (p = 0 ; p < PACKETS ; p++)
+        {
+          if (simd)
+            {
+              czmil_delta_decode (&reader, PACKET, numbits, offset, 500, samples);
+            }
+          else
+            {
+              czmil_delta_decode_scalar (&reader, PACKET, numbits, offset, 500, samples);
+            }
+
+          sink += samples[PACKET];
+        }
+    }
+
+  return (rate (start, passes));
+}
+
+
+/*  Checks every method against czmil_bit_unpack for the first few packets.  */
+
+static int32_t check (uint32_t numbits)
+{
+  int32_t p, k, simd;
+  uint32_t bpos = 0;
+  int16_t offset = (int16_t) (1 << (numbits ? numbits - 1 : 0)), previous;
+  CZMIL_BIT_READER array_reader, kernel_reader, delta_reader[2];
+  uint32_t array_values[PACKET];
+  uint16_t delta_samples[PACKET + 1];
+
+
+  czmil_bit_reader_init (&array_reader, buffer, BUFFER_BYTES, 0);
+  czmil_bit_reader_init (&kernel_reader, buffer, BUFFER_BYTES, 0);
+  czmil_bit_reader_init (&delta_reader[0], buffer, BUFFER_BYTES, 0);
+  czmil_bit_reader_init (&delta_reader[1], buffer, BUFFER_BYTES, 0);
+
+  for (p = 0 ; p < 64 ; p++, bpos += PACKET * numbits)
+    {
+      czmil_bit_read_array (&array_reader, PACKET, numbits, array_values);
+      (*czmil_unpack_select (numbits)) (&kernel_reader, PACKET, values);
+
+      for (k = 0 ; k < PACKET ; k++)
+        {
+          if (array_values[k] != czmil_bit_unpack (buffer, bpos + k * numbits, numbits) || values[k] != array_values[k]) return (-1);
+        }
+
+      if (numbits && numbits <= 16)
+        {
+          for (simd = 0 ; simd < 2 ; simd++)
+            {
+              if (simd)
+                {
+                  czmil_delta_decode (&delta_reader[simd], PACKET, numbits, offset, 500, delta_samples);
+                }
+              else
+                {
+                  czmil_delta_decode_scalar (&delta_reader[simd], PACKET, numbits, offset, 500, delta_samples);
+                }
+
+              previous = 500;
+              for (k = 1 ; k <= PACKET ; k++)
+                {
+                  previous = (int16_t) (array_values[k - 1] - offset) + previous;
+                  if (delta_samples[k] != (uint16_t) previous) return (-1);
+                }
+            }
+        }
+    }
+
+  return (0);
+}
+
+
+int main (int argc, char **argv)
+{
+  int32_t i, passes = argc > 1 ? atoi (argv[1]) : 20;
+  uint32_t numbits;
+  static const char *simd_name[3] = {"none", "SSE4.2", "AVX2"};
+
+
+  srand (5);
+  for (i = 0 ; i < BUFFER_BYTES ; i++) buffer[i] = (uint8_t) rand ();
+
+
+  printf ("Unpacking %d packets of %d values, %d passes (millions of values per second)\n\n", PACKETS, PACKET, passes);
+  printf ("bits  czmil_bit_unpack  czmil_bit_read_array  CZMIL_UNPACK_KERNEL\n");
+
+  for (numbits = 1 ; numbits <= 32 ; numbits++)
+    {
+      if (check (numbits))
+        {
+          fprintf (stderr, "%d bit values don't match czmil_bit_unpack\n", numbits);
+          return (1);
+        }
+
+      printf ("%4d  %16.1f  %20.1f  %19.1f\n", numbits, unpack_old (numbits, passes), unpack_array (numbits, passes),
+              unpack_kernel (numbits, passes));
+    }
+
+
+  printf ("\nDelta decode, SIMD level %s\n\n", simd_name[czmil_simd_level ()]);
+  printf ("bits  czmil_bit_unpack  czmil_delta_decode_scalar  czmil_delta_decode\n");
+
+  for (numbits = 1 ; numbits <= 16 ; numbits++)
+    {
+      printf ("%4d  %16.1f  %25.1f  %18.1f\n", numbits, delta_old (numbits, passes), delta_new (numbits, passes, 0),
+              delta_new (numbits, passes, 1));
+    }
+
+
+  return (0);
+}